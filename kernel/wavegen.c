@@ -20,8 +20,8 @@
 #include <string.h>     // strcmp
 #include "wavegen_ip.h" // wavegen ip library
 #include "wavegenIp_regs.h"
-
-#define printd(format, ...) printf("[DEBUG][%d][%s][%s] " format "\n", __LINE__, __FILE__, __func__, ##__VA_ARGS__) // Debug print
+#include "wavegen_trace.h" // trace
+#include "wavegen_daemon.h" // daemon protocol
 
 #define MODE_DC 0
 #define MODE_SINE 1
@@ -29,6 +29,7 @@
 #define MODE_TRIANGLE 3
 #define MODE_SQUARE 4
 #define MODE_ARB 5
+#define MODE_STREAM 6
 
 typedef struct
 {
@@ -53,7 +54,7 @@ void parseArguments(int argc, char *argv[], WaveGenArgs *args, wavegen_fpArgs *f
 {
     // Initialize default values
     args->isDc = 0;
-    printd();
+    trace(TRACE_DEBUG, "argc %d", argc);
     strncpy((char *)args->mode, argv[1], sizeof(args->mode));
 
     if (argc > 4)
@@ -92,7 +93,7 @@ void parseArguments(int argc, char *argv[], WaveGenArgs *args, wavegen_fpArgs *f
             args->isDc = 1;
             args->offset = atof(argv[3]);
             fpArgs->offset_fp = (args->offset) * (1 << 14) / 2.5;
-            printd();
+            trace(TRACE_DEBUG, "dc ofs %d", fpArgs->offset_fp);
         }
 
         else if (!strcmp((char *)args->mode, "cycles"))
@@ -100,13 +101,94 @@ void parseArguments(int argc, char *argv[], WaveGenArgs *args, wavegen_fpArgs *f
             args->cycles = atoi(argv[3]);
         }
 
+        else if (!strcmp((char *)args->mode, "arbload"))
+        {
+            args->mode_num = MODE_ARB;
+        }
+
     }
     else
     {
         // Handle invalid number of arguments
         printf("  command not understood\n");
     }
-    printd();
+    trace(TRACE_DEBUG, "ch %d, mode %d", args->channel, args->mode_num);
+}
+
+// Forward a parsed command to a running daemon instead of mapping the IP
+int sendToDaemon(const char *path, char *argv[], WaveGenArgs *args, wavegen_fpArgs *fpArgs)
+{
+    WaveGenCommand command = {0};
+    WaveGenArbLoad table = {0};
+    WaveGenReply reply;
+    const void *message = &command;
+    size_t length = sizeof(command);
+    FILE *file;
+    uint8_t i;
+
+    command.channel   = args->channel;
+    command.mode      = args->mode_num;
+    command.frequency = args->freq;
+    command.amplitude = fpArgs->amp_fp;
+    command.offset    = fpArgs->offset_fp;
+    command.duty      = fpArgs->duty_fp;
+    command.cycles    = args->cycles;
+
+    if (strcmp(argv[1], "rate") == 0 && argv[2] != NULL)
+        command.frequency = atoi(argv[2]);       // Sample rate travels in the frequency field
+
+    if      (strcmp(argv[1], "dc") == 0)        command.command = WAVEGEN_CMD_DC;
+    else if (strcmp(argv[1], "cycles") == 0)    command.command = WAVEGEN_CMD_CYCLES;
+    else if (strcmp(argv[1], "stop") == 0)      command.command = WAVEGEN_CMD_STOP;
+    else if (strcmp(argv[1], "status") == 0)    command.command = WAVEGEN_CMD_STATUS;
+    else if (strcmp(argv[1], "rate") == 0)      command.command = WAVEGEN_CMD_RATE;
+    else if (strcmp(argv[1], "arbload") == 0)   command.command = WAVEGEN_CMD_ARB_LOAD;
+    else if (strcmp(argv[1], "sine") == 0 || strcmp(argv[1], "saw") == 0 || strcmp(argv[1], "tri") == 0 ||
+             strcmp(argv[1], "sq") == 0 || strcmp(argv[1], "arb") == 0)
+        command.command = WAVEGEN_CMD_SET_CHANNEL;
+    else
+    {
+        printf("  %s is not served by the daemon\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    // The table is read here and travels with the command
+    if (command.command == WAVEGEN_CMD_ARB_LOAD)
+    {
+        file = (argv[2] != NULL && argv[3] != NULL) ? fopen(argv[3], "rb") : NULL;
+        if (file == NULL)
+        {
+            printf("  usage: arbload OUT FILE, cannot open the file\n");
+            return EXIT_FAILURE;
+        }
+        table.command = command;
+        table.count   = fread(table.samples, sizeof(int16_t), ARB_SAMPLES, file);
+        fclose(file);
+
+        message = &table;
+        length  = sizeof(table);
+    }
+
+    if (!waveGenSend(path, message, length, &reply))
+    {
+        printf("  daemon not reachable on %s\n", path);
+        return EXIT_FAILURE;
+    }
+
+    if (command.command == WAVEGEN_CMD_STATUS)
+    {
+        for (i = 0; i < 2; i++)
+        {
+            printf("channel %c: mode %u freq %u amp %u ofs %d duty %u cycles %u phase %u hilbert %u comp %u run %u\n",
+                   'A' + i, reply.channel[i].mode, reply.channel[i].frequency, reply.channel[i].amplitude,
+                   reply.channel[i].offset, reply.channel[i].duty, reply.channel[i].cycles, reply.channel[i].phase,
+                   reply.channel[i].hilbert, reply.channel[i].complement, reply.channel[i].run);
+        }
+    }
+
+    if (reply.status != 0)
+        printf("  daemon rejected %s (%d)\n", argv[1], reply.status);
+    return reply.status == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
 }
 
 int main(int argc, char *argv[])
@@ -115,29 +197,41 @@ int main(int argc, char *argv[])
      * @brief Variables for different arguments
      * @todo give scale conversion factors to dc volts and offset and amplitude
      * @todo give default values all variables except mode
-     * @todo Save the previous values in a file and read them out when run is received
      */
-    printd();
-
-    waveGenOpen();
-
     WaveGenArgs args = {0};
     wavegen_fpArgs fpArgs = {0};
+    const char *socketPath = getenv("WAVEGEN_SOCKET");
+
+    // Map the IP once and serve commands until killed
+    if (argc >= 2 && strcmp(argv[1], "daemon") == 0)
+    {
+        if (!waveGenOpen())
+            return EXIT_FAILURE;
+        return waveGenDaemon(argc > 2 ? argv[2] : WAVEGEN_SOCKET_PATH) == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
 
     parseArguments(argc, argv, &args, &fpArgs);
 
+    // The daemon keeps the IP mapped and the configuration of both channels
+    if (socketPath != NULL)
+        return sendToDaemon(socketPath, argv, &args, &fpArgs);
+
+    waveGenOpen();
+
     // Access parsed arguments
-    printf("Mode:\t %s \nModN:\t%d\n",    args.mode, args.mode_num);
-    printf("Chan:\t %d \n",               args.channel);
-    printf("Freq:\t %u \n",               args.freq);
-    printf("Ampl:\t %f \t %d\n",          args.amp, fpArgs.amp_fp);
-    printf("Ofst:\t %f \t %d\n",          args.offset, fpArgs.offset_fp);
-    printf("Duty:\t %f \t %d\n",          args.duty, fpArgs.duty_fp);
-    printf("Cycl:\t %u \n",               args.cycles);
+    if (WAVEGEN_TRACE_LEVEL >= TRACE_INFO)
+    {
+        printf("Mode:\t %s \nModN:\t%d\n",    args.mode, args.mode_num);
+        printf("Chan:\t %d \n",               args.channel);
+        printf("Freq:\t %u \n",               args.freq);
+        printf("Ampl:\t %f \t %d\n",          args.amp, fpArgs.amp_fp);
+        printf("Ofst:\t %f \t %d\n",          args.offset, fpArgs.offset_fp);
+        printf("Duty:\t %f \t %d\n",          args.duty, fpArgs.duty_fp);
+        printf("Cycl:\t %u \n",               args.cycles);
+    }
 
     if (argc == 2 && (strcmp(argv[1], "-h") == 0 || strcmp(argv[1], "--help") == 0))
     {
-        printd();
         printf("  usage:\n");
         printf("  dc OUT, OFS           make the pin a push-pull output\n");
         printf("  cycles OUT, N            make the pin an open drain output\n");
@@ -146,14 +240,22 @@ int main(int argc, char *argv[])
         printf("  sawtooth OUT, FREQ, AMP, [OFS]          set the pin high\n");
         printf("  triangle OUT, FREQ, AMP, [OFS]           set the pin low\n");
         printf("  square OUT FREQ, AMP, [OFS, [DC]]        get the pin status\n");
+        printf("  arb OUT FREQ, AMP, [OFS]          play the loaded sample table\n");
+        printf("  arbload OUT FILE                  load int16 Q14 samples into the table\n");
+        printf("  \n");
+        printf("  rate HZ                           set the sample rate of both channels\n");
         printf("  \n");
         printf("  run \n");
         printf("  stop \n");
         printf("  status \n");
         printf("  \n");
+        printf("  daemon [SOCKET]                   keep the IP mapped and serve commands\n");
+        printf("  \n");
     }
 
     // Set the values based on the parsed arguments
+    // (staged and written once per register, run bits last)
+    waveGenBegin();
     if (strcmp(argv[1], "dc") == 0)
     {
         setChannelMode(args.channel, args.mode_num); // Assuming mode setting is common for all waveform types
@@ -164,6 +266,25 @@ int main(int argc, char *argv[])
     {
         setCycles(args.channel, args.cycles); // Set continuous
     }
+    else if (strcmp(argv[1], "rate") == 0 && argc > 2)
+    {
+        setSampleRate(atoi(argv[2]));
+    }
+    else if (strcmp(argv[1], "arbload") == 0)
+    {
+        // Raw int16_t samples, signed Q14, one table period
+        int16_t samples[ARB_SAMPLES];
+        FILE *file = fopen(argv[3], "rb");
+        if (file != NULL)
+        {
+            setArbSamples(args.channel, samples, fread(samples, sizeof(int16_t), ARB_SAMPLES, file));
+            fclose(file);
+        }
+        else
+        {
+            printf("  cannot open %s\n", argv[3]);
+        }
+    }
 
     else
     {
@@ -188,12 +309,18 @@ int main(int argc, char *argv[])
             setRun(args.channel, 0);
         }
     }
+    waveGenCommit();
 
     if (strcmp(argv[1], "status") == 0)
     {
         getStatus();
     }
-    printd();
+
+    // Dump the trace ring on request
+    if (getenv("WAVEGEN_TRACE") != NULL)
+    {
+        waveGenTraceDump();
+    }
 
     return EXIT_SUCCESS;
 }
\ No newline at end of file
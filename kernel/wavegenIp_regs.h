@@ -19,6 +19,7 @@
 #ifndef WAVEGENIP_REGS_H
 #define WAVEGENIP_REGS_H
 
+// Global registers, OFS_MODE to OFS_CYCLES pack channel 0 and 1 (A and B)
 #define OFS_MODE 0
 #define OFS_RUN 1
 #define OFS_FREQA 2
@@ -27,7 +28,48 @@
 #define OFS_AMPLITUDE 5
 #define OFS_DTYCYC 6
 #define OFS_CYCLES 7
+#define OFS_SRATE 8
+#define OFS_CHANNELS 9              // Channel count of the IP (read only)
+#define OFS_RUN_MASK 10             // Bit n runs channel n
+#define OFS_TRIGGER 11              // Write 1 to bit n to start a burst on channel n
+#define OFS_BURST_DONE 12           // Bit n set when channel n finished a burst, write 1 to clear
+#define OFS_TRIGGER_EXT 13          // Bit n starts channel n on the external trigger
 
-#define SPAN_IN_BYTES 32
+#define SPAN_IN_BYTES 56
+
+// Sample rate in Hz, shared by every channel (0 reads back as the power up rate)
+#define SRATE_DEFAULT 50000
+#define SRATE_MIN 1000              // Sampling clock toggle count fits in 16 bits
+#define SRATE_MAX 400000            // One DAC SPI update per sample
+
+// Channel register banks, one per channel at byte 0x1000 + channel * 0x20
+// (channel 0 and 1 are also reachable through the packed global registers)
+#define WAVEGEN_MAX_CHANNELS 14
+#define WAVEGEN_DEFAULT_CHANNELS 2
+#define OFS_CHANNEL_BANK 0x400      // Channel 0 bank at byte 0x1000
+#define CHANNEL_STRIDE 8            // Registers per bank
+#define OFS_CH(channel, reg) (OFS_CHANNEL_BANK + (channel) * CHANNEL_STRIDE + (reg))
+
+#define OFS_CH_CTRL 0               // Mode in bits 2:0, CH_CTRL_ flags
+#define OFS_CH_FREQ 1               // Hz
+#define OFS_CH_OFFSET 2             // Signed Q14 in bits 15:0
+#define OFS_CH_AMPLITUDE 3          // Signed Q14 in bits 15:0
+#define OFS_CH_DTYCYC 4             // Q14 fraction of the period in bits 15:0
+#define OFS_CH_CYCLES 5             // 0 = continuous, n = n periods per trigger
+#define OFS_CH_PHASE 6              // Phase offset in bits 15:0, 2^16 = 360 degrees
+
+#define CH_CTRL_MODE 0x07
+#define CH_CTRL_HILBERT 0x08
+#define CH_CTRL_COMPLEMENT 0x10
+
+// Arbitrary waveform sample tables (write only, one signed Q14 sample per word)
+#define OFS_ARB(channel) (0x800 + (channel) * 0x400) // Channel n table at byte 0x2000 + n * 0x1000
+#define OFS_ARB_A OFS_ARB(0)        // Channel A table at byte 0x2000
+#define OFS_ARB_B OFS_ARB(1)        // Channel B table at byte 0x3000
+#define ARB_SAMPLES 1024            // Samples per channel
+#define ARB_OFFSET_IN_BYTES 0x2000  // Start of the tables
+#define ARB_TABLE_IN_BYTES 0x1000   // One table
+#define ARB_SPAN_IN_BYTES (WAVEGEN_MAX_CHANNELS * ARB_TABLE_IN_BYTES) // Every table
+#define IP_SPAN_IN_BYTES 0x10000    // Registers, banks and tables (16 bit AXI address)
 
 #endif
\ No newline at end of file
@@ -0,0 +1,267 @@
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: Xilinx XUP Blackboard
+
+// AXI4-Lite interface:
+//   Mapped to offset of 0 (once, by the daemon)
+//
+// Daemon:
+//   Keeps the IP mapped and the configuration of both channels in memory
+//   and serves the binary protocol of wavegen_daemon.h on a Unix domain socket
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>         // C99 integer types -- uint32_t
+#include <stdbool.h>        // bool
+#include <stdio.h>          // printf
+#include <string.h>         // memset, strncpy
+#include <errno.h>          // EINVAL, EINTR
+#include <poll.h>           // poll
+#include <unistd.h>         // close, unlink
+#include <sys/socket.h>     // socket, bind, listen, accept
+#include <sys/un.h>         // sockaddr_un
+#include "wavegen_ip.h"     // wavegen functions
+#include "wavegen_daemon.h" // daemon protocol
+#include "wavegen_trace.h"  // trace
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+#define MAX_CLIENTS 8
+
+static WaveGenCommand state[2];     // Last configuration applied to channel A and B
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+static void fillAddress(struct sockaddr_un *address, const char *path)
+{
+    memset(address, 0, sizeof(*address));
+    address->sun_family = AF_UNIX;
+    strncpy(address->sun_path, path, sizeof(address->sun_path) - 1);
+}
+
+// Apply one command to the IP and the kept state, all registers in one batch
+static int execute(const WaveGenCommand *command)
+{
+    WaveGenCommand *channel;
+    uint32_t i;
+
+    if (command->command != WAVEGEN_CMD_STOP && command->command != WAVEGEN_CMD_STATUS &&
+        command->command != WAVEGEN_CMD_RATE && command->channel > 1)
+        return -EINVAL;
+
+    channel = &state[command->channel & 1];
+
+    waveGenBegin();
+    switch (command->command)
+    {
+        case WAVEGEN_CMD_SET_CHANNEL:
+            setChannelMode(command->channel, command->mode);
+            setFrequency(command->channel, command->frequency);
+            setAmplitude(command->channel, command->amplitude);
+            setOffset(command->channel, command->offset);
+            setDutyCycle(command->channel, command->duty);
+            setRun(command->channel, 1);
+
+            channel->mode      = command->mode;
+            channel->frequency = command->frequency;
+            channel->amplitude = command->amplitude;
+            channel->offset    = command->offset;
+            channel->duty      = command->duty;
+            channel->run       = 1;
+            break;
+
+        case WAVEGEN_CMD_DC:
+            setChannelMode(command->channel, 0);
+            setOffset(command->channel, command->offset);
+            setRun(command->channel, 1);
+
+            channel->mode   = 0;
+            channel->offset = command->offset;
+            channel->run    = 1;
+            break;
+
+        case WAVEGEN_CMD_CYCLES:
+            setCycles(command->channel, command->cycles);
+            channel->cycles = command->cycles;
+            break;
+
+        case WAVEGEN_CMD_RUN:
+            setRun(command->channel, command->run ? 1 : 0);
+            channel->run = command->run ? 1 : 0;
+            break;
+
+        case WAVEGEN_CMD_PHASE:
+            setPhase(command->channel, command->phase);
+            channel->phase = command->phase;
+            break;
+
+        case WAVEGEN_CMD_HILBERT:
+            setHilbert(command->channel, command->hilbert ? 1 : 0);
+            channel->hilbert = command->hilbert ? 1 : 0;
+            break;
+
+        case WAVEGEN_CMD_COMPLEMENT:
+            setComplement(command->channel, command->complement ? 1 : 0);
+            channel->complement = command->complement ? 1 : 0;
+            break;
+
+        case WAVEGEN_CMD_STOP:
+            for (i = 0; i < 2; i++)
+            {
+                setChannelMode(i, 0);
+                setFrequency(i, 0);
+                setAmplitude(i, 0);
+                setOffset(i, 0);
+                setDutyCycle(i, 0);
+                setPhase(i, 0);
+                setHilbert(i, 0);
+                setComplement(i, 0);
+                setRun(i, 0);
+            }
+            memset(state, 0, sizeof(state));
+            break;
+
+        case WAVEGEN_CMD_RATE:
+            setSampleRate(command->frequency);
+            break;
+
+        case WAVEGEN_CMD_STATUS:
+            break;
+
+        default:
+            waveGenCommit();
+            return -EINVAL;
+    }
+    waveGenCommit();
+
+    trace(TRACE_DEBUG, "cmd %d, ch %d", command->command, command->channel);
+    return 0;
+}
+
+// Load the sample table of a channel, played in mode arb
+static int loadTable(const WaveGenArbLoad *message)
+{
+    if (message->command.channel > 1 || message->count > ARB_SAMPLES)
+        return -EINVAL;
+
+    setArbSamples(message->command.channel, message->samples, message->count);
+
+    trace(TRACE_DEBUG, "table ch %d, %d samples", message->command.channel, message->count);
+    return 0;
+}
+
+/**
+ *      @brief Function to serve commands until the socket fails
+ *                (IP must already be opened with waveGenOpen())
+ *      @param path of the Unix domain socket to create
+ *      @return int 0 on clean exit, -1 if the socket could not be set up
+ **/
+int waveGenDaemon(const char *path)
+{
+    struct pollfd fds[1 + MAX_CLIENTS];
+    struct sockaddr_un address;
+    WaveGenArbLoad message;
+    WaveGenReply reply;
+    nfds_t count = 1;
+    nfds_t i;
+    ssize_t length;
+
+    fds[0].fd = socket(AF_UNIX, SOCK_SEQPACKET, 0);
+    fds[0].events = POLLIN;
+    if (fds[0].fd < 0)
+        return -1;
+
+    fillAddress(&address, path);
+    unlink(path);
+    if (bind(fds[0].fd, (struct sockaddr *)&address, sizeof(address)) < 0 || listen(fds[0].fd, MAX_CLIENTS) < 0)
+    {
+        close(fds[0].fd);
+        return -1;
+    }
+    printf("wavegen daemon listening on %s\n", path);
+    fflush(stdout);
+
+    for (;;)
+    {
+        // A signal only interrupts the wait
+        if (poll(fds, count, -1) < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+
+        // New client
+        if (fds[0].revents & POLLIN)
+        {
+            fds[count].fd = accept(fds[0].fd, NULL, NULL);
+            fds[count].events = POLLIN;
+            fds[count].revents = 0;
+            if (fds[count].fd >= 0)
+                count++;
+        }
+
+        // One reply per command
+        for (i = 1; i < count; i++)
+        {
+            if (!fds[i].revents)
+                continue;
+
+            length = recv(fds[i].fd, &message, sizeof(message), 0);
+            if (length <= 0)
+            {
+                close(fds[i].fd);
+                fds[i--] = fds[--count];
+                continue;
+            }
+
+            if (length == sizeof(message) && message.command.command == WAVEGEN_CMD_ARB_LOAD)
+                reply.status = loadTable(&message);
+            else if (length == sizeof(WaveGenCommand) && message.command.command != WAVEGEN_CMD_ARB_LOAD)
+                reply.status = execute(&message.command);
+            else
+                reply.status = -EINVAL;
+            memcpy(reply.channel, state, sizeof(state));
+            send(fds[i].fd, &reply, sizeof(reply), MSG_NOSIGNAL);
+        }
+
+        // Pending connections wait in the backlog while every slot is taken
+        fds[0].events = (count < 1 + MAX_CLIENTS) ? POLLIN : 0;
+    }
+
+    close(fds[0].fd);
+    unlink(path);
+    return 0;
+}
+
+/**
+ *      @brief Function to send one message to a running daemon
+ *      @param path of the daemon socket
+ *      @param message WaveGenCommand, or WaveGenArbLoad for WAVEGEN_CMD_ARB_LOAD
+ *      @param length of the message in bytes
+ *      @param reply received from the daemon
+ *      @return true if the message was delivered and answered
+ **/
+bool waveGenSend(const char *path, const void *message, size_t length, WaveGenReply *reply)
+{
+    struct sockaddr_un address;
+    int file = socket(AF_UNIX, SOCK_SEQPACKET, 0);
+    bool bOK = (file >= 0);
+
+    fillAddress(&address, path);
+    if (bOK)
+        bOK = (connect(file, (struct sockaddr *)&address, sizeof(address)) == 0);
+    if (bOK)
+        bOK = (send(file, message, length, 0) == (ssize_t)length);
+    if (bOK)
+        bOK = (recv(file, reply, sizeof(*reply), 0) == sizeof(*reply));
+
+    if (file >= 0)
+        close(file);
+    return bOK;
+}
@@ -0,0 +1,78 @@
+// WAVEGEN daemon protocol
+// Shared by the wavegen daemon and its clients
+
+//-----------------------------------------------------------------------------
+// Protocol:
+//   The daemon maps the IP once and listens on a Unix domain socket
+//   (SOCK_SEQPACKET, one message per command). A client may keep the
+//   connection open and send any number of commands; every command is
+//   answered with one reply holding the status and the configuration the
+//   daemon keeps for both channels. WAVEGEN_CMD_ARB_LOAD is the only
+//   longer message, a WaveGenArbLoad carrying the samples.
+//   Field values use the same fixed point units as the setters in
+//   wavegen_ip.h
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#ifndef WAVEGEN_DAEMON_H
+#define WAVEGEN_DAEMON_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "wavegenIp_regs.h" // ARB_SAMPLES
+
+#define WAVEGEN_SOCKET_PATH "/tmp/wavegen.sock"
+
+#define WAVEGEN_CMD_SET_CHANNEL 1   // Mode, frequency, amplitude, offset, duty of a channel, then run
+#define WAVEGEN_CMD_DC          2   // DC offset of a channel, then run
+#define WAVEGEN_CMD_CYCLES      3   // Cycle count of a channel
+#define WAVEGEN_CMD_RUN         4   // Run bit of a channel
+#define WAVEGEN_CMD_STOP        5   // Clear both channels
+#define WAVEGEN_CMD_STATUS      6   // Only reply
+#define WAVEGEN_CMD_RATE        7   // Sample rate of both channels, in frequency
+#define WAVEGEN_CMD_ARB_LOAD    8   // Sample table of a channel, sent as WaveGenArbLoad
+#define WAVEGEN_CMD_PHASE       9   // Phase offset of a channel
+#define WAVEGEN_CMD_HILBERT     10  // Hilbert flag of a channel
+#define WAVEGEN_CMD_COMPLEMENT  11  // Complement flag of a channel
+
+typedef struct
+{
+    uint8_t  command;               // WAVEGEN_CMD_
+    uint8_t  channel;               // 0 = A, 1 = B
+    uint8_t  mode;
+    uint8_t  run;
+    uint32_t frequency;
+    uint16_t amplitude;
+    int16_t  offset;
+    uint16_t duty;
+    uint16_t cycles;
+    uint16_t phase;                 // 2^16 = 360 degrees
+    uint8_t  hilbert;
+    uint8_t  complement;
+} WaveGenCommand;
+
+typedef struct
+{
+    WaveGenCommand command;         // WAVEGEN_CMD_ARB_LOAD and the channel
+    uint16_t count;                 // Samples used, up to ARB_SAMPLES
+    int16_t samples[ARB_SAMPLES];   // Signed Q14
+} WaveGenArbLoad;
+
+typedef struct
+{
+    int32_t status;                 // 0 or a negative errno
+    WaveGenCommand channel[2];      // Configuration kept for channel A and B
+} WaveGenReply;
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+int waveGenDaemon(const char *path);
+bool waveGenSend(const char *path, const void *message, size_t length, WaveGenReply *reply);
+
+#endif
@@ -14,9 +14,29 @@
 #include <linux/init.h>     // __init
 #include <linux/kobject.h>  // kobject, kobject_atribute,
                             // kobject_create_and_add, kobject_put
+#include <linux/fs.h>       // file_operations
+#include <linux/miscdevice.h> // misc_register, misc_deregister
+#include <linux/uaccess.h>  // copy_from_user
+#include <linux/vmalloc.h>  // vmalloc_user, vfree, remap_vmalloc_range
+#include <linux/mm.h>       // io_remap_pfn_range
+#include <linux/dmaengine.h> // dmaengine_prep_slave_single
+#include <linux/dma-mapping.h> // dma_alloc_coherent, dma_mmap_coherent
+#include <linux/wait.h>     // wait_queue_head_t
+#include <linux/poll.h>     // poll_wait
+#include <linux/interrupt.h> // request_irq, free_irq
+#include <linux/workqueue.h> // delayed_work
+#include <linux/eventfd.h>  // eventfd_ctx_fdget, eventfd_signal
+#include <linux/slab.h>     // kzalloc, kfree
+#include <linux/version.h>  // LINUX_VERSION_CODE
+#include <linux/of.h>       // of_find_compatible_node, of_node_put
+#include <linux/of_irq.h>   // irq_of_parse_and_map
+#include <linux/of_dma.h>   // of_dma_request_slave_channel
 #include <asm/io.h>         // iowrite, ioread, ioremap_nocache (platform specific)
 #include "../address_map.h" // overall memory map
 #include "wavegen_regs.h"
+#include "wavegen_ioctl.h"  // character device interface
+#include "wavegen_shadow.h" // shadow registers and device lock
+#include "wavegen_trace.h"  // trace ring
 
 
 // Kernel module information
@@ -30,124 +50,88 @@ MODULE_DESCRIPTION("Wavegen IP Driver");
 #define MODE_TRI    3
 #define MODE_SQR    4
 #define MODE_ARB    5
+#define MODE_STREAM 6
 
-#define CHANNEL_A   0
-#define CHANNEL_B   1
-#define CHANNEL_AB  2
+#define CHANNEL_ALL -1
 #define SCALE_CONSTANT (1 << 14)
 
-static unsigned int *base = NULL;
+// Mapped IP registers and their shadow copy, every access is served from
+// the shadow and only writes go out over the AXI bus
+static struct wavegen_device wavegen;
+
+static bool mock = false;
+module_param(mock, bool, S_IRUGO);
+MODULE_PARM_DESC(mock, " Use an in-memory register page instead of the IP");
+
+static unsigned int channels = 0;
+module_param(channels, uint, S_IRUGO);
+MODULE_PARM_DESC(channels, " Channels of the IP (0 = read from the IP)");
+
+// Device tree node of the IP, its first interrupt is the burst done line
+// on IRQ_F2P (0 = no node or no interrupt, poll the done register)
+#define WAVEGEN_COMPATIBLE "xlnx,wavegen-soc-1.0"
+static struct device_node *node;
+static int irq = 0;
 
 char mode[10];
 
 // Subroutines
 /**
- *      @brief Function to set the MODE register
+ *      @brief Function to set the mode field of a channel control register
  *      @param channel in which to set
  *      @param mode to be set for the channel
  **/
 void updateMode(int channel, int mode)
 {
-    unsigned int value = ioread32(base + OFS_MODE);
-
-    if (channel == CHANNEL_A)
-    {
-        value = value & 0x38;     // Clear out the existing values
-
-        if (mode == MODE_DC)  iowrite32(value | MODE_DC , (base + OFS_MODE));  // Mode for DC Wave
-        if (mode == MODE_SIN) iowrite32(value | MODE_SIN, (base + OFS_MODE));  // Mode for DC Wave
-        if (mode == MODE_SAW) iowrite32(value | MODE_SAW, (base + OFS_MODE));  // Mode for DC Wave
-        if (mode == MODE_TRI) iowrite32(value | MODE_TRI, (base + OFS_MODE));  // Mode for DC Wave
-        if (mode == MODE_SQR) iowrite32(value | MODE_SQR, (base + OFS_MODE));  // Mode for DC Wave
-
-    }
-    else if (channel == CHANNEL_B)
-    {
-        value = value & 0x07;     // Clear out the existing values
-
-        if (mode == MODE_DC)  iowrite32(value | (MODE_DC  << 3), (base + OFS_MODE));  // Mode for DC Wave
-        if (mode == MODE_SIN) iowrite32(value | (MODE_SIN << 3), (base + OFS_MODE));  // Mode for DC Wave
-        if (mode == MODE_SAW) iowrite32(value | (MODE_SAW << 3), (base + OFS_MODE));  // Mode for DC Wave
-        if (mode == MODE_TRI) iowrite32(value | (MODE_TRI << 3), (base + OFS_MODE));  // Mode for DC Wave
-        if (mode == MODE_SQR) iowrite32(value | (MODE_SQR << 3), (base + OFS_MODE));  // Mode for DC Wave
-    }
+    if (mode > MODE_STREAM) return;
 
+    modifyRegister(&wavegen, OFS_CH(channel, OFS_CH_CTRL), CH_CTRL_MODE, mode);
 }
 
 /**
- *      @brief Get the Mode register
- *      @return uint32_t register value
+ *      @brief Get the Mode of a channel
+ *      @param channel to read
+ *      @return uint32_t mode
  **/
-unsigned int getMode(void)
+unsigned int getMode(int channel)
 {
-    return (ioread32(base + OFS_MODE));                                                 // Read current value
+    return readRegister(&wavegen, OFS_CH(channel, OFS_CH_CTRL)) & CH_CTRL_MODE;         // Read current value
 }
 
 /**
-*      @brief Function to set the RUN register
-*      @param channel in which to set
+*      @brief Function to set the RUN MASK register
+*      @param channel in which to set, CHANNEL_ALL for every channel
+*      @param run 1 to run, 0 to stop
 **/
 void updateRun(int channel, int run)
 {
-    unsigned int value = ioread32(base + OFS_RUN);                                      // Read current value
-
-    value = value;
+    uint32_t bits;
 
-    if (run == 1)
-    {
-        if      (channel == CHANNEL_A)  iowrite32((value | 0x01), (base + OFS_RUN));    // Channel A
-        else if (channel == CHANNEL_B)  iowrite32((value | 0x02), (base + OFS_RUN));    // Channel B
-        else if (channel == CHANNEL_AB) iowrite32((value | 0x03), (base + OFS_RUN));    // Channel A+B
-    }
-
-    else if (run == 0)
-    {
-        if      (channel == CHANNEL_A)  iowrite32((value & 0x02), (base + OFS_RUN));    // Channel A
-        else if (channel == CHANNEL_B)  iowrite32((value & 0x01), (base + OFS_RUN));    // Channel B
-        else if (channel == CHANNEL_AB) iowrite32((value & 0x0C), (base + OFS_RUN));    // Channel A+B
-    }
+    if (channel == CHANNEL_ALL) bits = (1u << channels) - 1;                            // Every channel at once
+    else                        bits = 1u << channel;
 
-    return;
+    if      (run == 1)  modifyRegister(&wavegen, OFS_RUN_MASK, 0, bits);
+    else if (run == 0)  modifyRegister(&wavegen, OFS_RUN_MASK, bits, 0);
 }
 
 /**
-*      @brief Get the Run register
-*      @return uint32_t register value
+*      @brief Get the Run Mask register
+*      @return uint32_t run bit of every channel
 **/
 unsigned int getRun(void)
 {
-    uint32_t value = 0;
-    value = ioread32(base + OFS_RUN) & 0x03; // Read current value
-
-    value = value & 3;
-
-    return value;
+    return readRegister(&wavegen, OFS_RUN_MASK);                                        // Read current value
 }
 
 /**
- *      @brief Function to update the complement mode in in the run register
- *      @param channel channel to complement with other
+ *      @brief Function to update the complement flag of a channel
+ *      @param channel channel to complement with the other channel of its DAC
  *      @param mode of complement
  **/
-void updateComplement (uint8_t channel, uint8_t mode)
+void updateComplement(int channel, int mode)
 {
-    uint32_t value = 0;
-    value = ioread32(base + OFS_RUN);                                                   // Read current value
-
-    if (channel == CHANNEL_A)
-    {
-        if (mode)   value = (value | 4);
-        else        value = (value & ~4);
-
-        iowrite32(value, (base + OFS_RUN));
-    }
-    else if (channel == CHANNEL_B)
-    {
-        if (mode)   value = (value | 8);
-        else        value = (value & ~8);
-
-        iowrite32(value, (base + OFS_RUN));
-    }
+    if (mode)   modifyRegister(&wavegen, OFS_CH(channel, OFS_CH_CTRL), 0, CH_CTRL_COMPLEMENT);
+    else        modifyRegister(&wavegen, OFS_CH(channel, OFS_CH_CTRL), CH_CTRL_COMPLEMENT, 0);
 }
 
 /**
@@ -157,12 +141,7 @@ void updateComplement (uint8_t channel, uint8_t mode)
 **/
 void updateFrequency(int channel, unsigned int frequency)
 {
-    uint32_t value = 0;
-
-    if      (channel == CHANNEL_A)  iowrite32(frequency, (base + OFS_FREQA));           // Channel A
-    else if (channel == CHANNEL_B)  iowrite32(frequency, (base + OFS_FREQB));           // Channel B
-
-    value = (ioread32(base + OFS_FREQA));               // Read current value
+    modifyRegister(&wavegen, OFS_CH(channel, OFS_CH_FREQ), 0xFFFFFFFF, frequency);
 }
 
 /**
@@ -173,42 +152,27 @@ void updateFrequency(int channel, unsigned int frequency)
  **/
 unsigned int getFrequency(int channel)
 {
-    uint32_t value;
-    if      (channel == CHANNEL_A)  value = (ioread32(base + OFS_FREQA));               // Read current value
-    else if (channel == CHANNEL_B)  value = (ioread32(base + OFS_FREQB));               // Read current value
-
-    return value;
+    return readRegister(&wavegen, OFS_CH(channel, OFS_CH_FREQ));                        // Read current value
 }
 
 /**
 *      @brief Function to update the offset register
 *      @param channel to set
+*      @param offset signed Q14 value to set
 **/
 void updateOffset(int channel, signed int offset)
 {
-    unsigned int value = ioread32(base + OFS_OFFSET);
-
-    if (channel == CHANNEL_A)
-    {
-        value = value & 0xFFFF0000;                                                     // Clear the lower 16
-        value = value | offset;
-        iowrite32(value, (base + OFS_OFFSET));                                          // Channel A
-    }
-    else if (channel == CHANNEL_B)
-    {
-        value = value & 0x0000FFFF;                                                     // Clear the upper 16
-        value = value | (offset << 16);
-        iowrite32(value, (base + OFS_OFFSET));                                          // Channel B
-    }
+    modifyRegister(&wavegen, OFS_CH(channel, OFS_CH_OFFSET), 0x0000FFFF, offset & 0x0000FFFF);
 }
 
 /**
  *      @brief Get the Offset object
- *      @return uint32_t
+ *      @param channel
+ *      @return int32_t
  **/
-int getOffset(void)
+int getOffset(int channel)
 {
-    return (ioread32(base + OFS_OFFSET));                                               // Read current value
+    return (int16_t)readRegister(&wavegen, OFS_CH(channel, OFS_CH_OFFSET));             // Read current value
 }
 
 /**
@@ -218,29 +182,17 @@ int getOffset(void)
 **/
 void updateAmplitude(int channel, signed int amplitude)
 {
-    unsigned int value = ioread32(base + OFS_AMPLITUDE);
-
-    if (channel == CHANNEL_A)
-    {
-        value = value & 0xFFFF0000;                                                     // Clear the lower 16
-        value = value | amplitude;
-        iowrite32(value, (base + OFS_AMPLITUDE));                                       // Channel A
-    }
-    else if (channel == CHANNEL_B)
-    {
-        value = value & 0x0000FFFF;                                                     // Clear the upper 16
-        value = value | (amplitude << 16);
-        iowrite32(value, (base + OFS_AMPLITUDE));                                       // Channel B
-    }
+    modifyRegister(&wavegen, OFS_CH(channel, OFS_CH_AMPLITUDE), 0x0000FFFF, amplitude & 0x0000FFFF);
 }
 
 /**
  *      @brief Get the Amplitude object
- *      @return uint32_t
+ *      @param channel
+ *      @return int32_t
  **/
-int32_t getAmplitude(void)
+int32_t getAmplitude(int channel)
 {
-    return (ioread32(base + OFS_AMPLITUDE));                                            // Read current value
+    return (int16_t)readRegister(&wavegen, OFS_CH(channel, OFS_CH_AMPLITUDE));          // Read current value
 }
 
 /**
@@ -250,27 +202,17 @@ int32_t getAmplitude(void)
 **/
 void updateDutyCycles(int channel, unsigned int duty)
 {
-    unsigned int value = ioread32(base + OFS_DTYCYC);
-
-    if (channel == CHANNEL_A)
-    {
-        value = value & 0xFFFF0000;
-        iowrite32(value | duty, (base + OFS_DTYCYC));                                   // Channel A
-    }
-    else if (channel == CHANNEL_B)
-    {
-        value = value & 0x0000FFFF;
-        iowrite32((value | (duty << 16)), (base + OFS_DTYCYC));                         // Channel B
-    }
+    modifyRegister(&wavegen, OFS_CH(channel, OFS_CH_DTYCYC), 0x0000FFFF, duty & 0x0000FFFF);
 }
 
 /**
  *      @brief Get the Duty cycles object
+ *      @param channel
  *      @return uint32_t
  **/
-uint32_t getDutyCycles(void)
+uint32_t getDutyCycles(int channel)
 {
-    return (ioread32(base + OFS_DTYCYC));                                               // Read current value
+    return readRegister(&wavegen, OFS_CH(channel, OFS_CH_DTYCYC));                      // Read current value
 }
 
 /**
@@ -280,27 +222,38 @@ uint32_t getDutyCycles(void)
 **/
 void updateCycles(int channel, unsigned int cycles)
 {
-    unsigned int value = ioread32(base + OFS_CYCLES);
-
-    if (channel == CHANNEL_A)
-    {
-        value = value & 0xFFFF0000;
-        iowrite32(value | cycles, (base + OFS_CYCLES));                                 // Channel A
-    }
-    else if (channel == CHANNEL_B)
-    {
-        value = value & 0x0000FFFF;
-        iowrite32((value | (cycles << 16)), (base + OFS_CYCLES));                       // Channel B
-    }
+    modifyRegister(&wavegen, OFS_CH(channel, OFS_CH_CYCLES), 0x0000FFFF, cycles & 0x0000FFFF);
 }
 
 /**
  *      @brief Get the Cycles object
+ *      @param channel
  *      @return uint32_t
  **/
-uint32_t getCycles(void)
+uint32_t getCycles(int channel)
+{
+    return readRegister(&wavegen, OFS_CH(channel, OFS_CH_CYCLES));                      // Read current value
+}
+
+/**
+*      @brief Function to set the Sample Rate register (every channel)
+*      @param rate in Hz, clamped to SRATE_MIN..SRATE_MAX
+**/
+void updateSampleRate(unsigned int rate)
+{
+    rate = clamp(rate, (unsigned int)SRATE_MIN, (unsigned int)SRATE_MAX);
+    modifyRegister(&wavegen, OFS_SRATE, 0xFFFFFFFF, rate);
+}
+
+/**
+ *      @brief Get the Sample Rate
+ *      @return uint32_t rate in Hz
+ **/
+uint32_t getSampleRate(void)
 {
-    return (ioread32(base + OFS_CYCLES));                                               // Read current value
+    uint32_t rate = readRegister(&wavegen, OFS_SRATE);                                  // Read current value
+
+    return (rate == 0) ? SRATE_DEFAULT : rate;
 }
 
 int32_t signAndScale(int32_t value, int32_t divisor)
@@ -315,35 +268,19 @@ int32_t signAndScale(int32_t value, int32_t divisor)
 }
 
 /**
- *      @brief Function to set the phase offset value into registers
- *                (Registers repurposed from other functions)
+ *      @brief Function to set the phase offset register
+ *                (Applied on the next sample, 2^16 = 360 degrees)
  *      @param channel to update
  *      @param phase value to set
  **/
-void updatePhase (int channel, uint16_t phase)
+void updatePhase(int channel, uint16_t phase)
 {
-    unsigned int value;
-
-    if (channel == CHANNEL_A)
-    {
-        value = ioread32(base + OFS_MODE);
-        value = value & 0x0000FFFF;
-        iowrite32((value | (phase << 16)), (base + OFS_MODE));                          // Channel A
-    }
-    else if (channel == CHANNEL_B)
-    {
-        value = ioread32(base + OFS_RUN);
-        value = value & 0x0000FFFF;
-        iowrite32((value | (phase << 16)), (base + OFS_RUN));                           // Channel B
-    }
+    modifyRegister(&wavegen, OFS_CH(channel, OFS_CH_PHASE), 0x0000FFFF, phase);
 }
 
 uint16_t getPhase(int8_t channel)
 {
-    if      (channel == CHANNEL_A)   return ((ioread32(base + OFS_MODE) & 0xFFFF0000) >> 16);
-    else if (channel == CHANNEL_B)   return ((ioread32(base + OFS_RUN) & 0xFFFF0000) >> 16);
-
-    return 0;
+    return readRegister(&wavegen, OFS_CH(channel, OFS_CH_PHASE)) & 0x0000FFFF;
 }
 
 /**
@@ -353,328 +290,373 @@ uint16_t getPhase(int8_t channel)
  **/
 void updateHilbert(int8_t channel, int8_t hilbertMode)
 {
-    unsigned int value;
-    value = ioread32(base + OFS_MODE);
-
-    if (channel == CHANNEL_A)
-    {
-        if (hilbertMode)    value = value | 64;
-        else                value = value & ~64;
-    }
-
-    else if (channel == CHANNEL_B)
-    {
-        if (hilbertMode)    value = value | 128;
-        else                value = value & ~128;
-    }
-
-    iowrite32(value, (base + OFS_MODE));                                    // Channel A
+    if (hilbertMode)    modifyRegister(&wavegen, OFS_CH(channel, OFS_CH_CTRL), 0, CH_CTRL_HILBERT);
+    else                modifyRegister(&wavegen, OFS_CH(channel, OFS_CH_CTRL), CH_CTRL_HILBERT, 0);
 }
 
-uint8_t getHilbert(void)
+uint8_t getHilbert(int8_t channel)
 {
-    return ioread32(base + OFS_MODE) & 0x192;
+    return (readRegister(&wavegen, OFS_CH(channel, OFS_CH_CTRL)) & CH_CTRL_HILBERT) ? 1 : 0;
 }
 
 //-----------------------------------------------------------------------------
-// Kernel Objects
+// Bursts
 //-----------------------------------------------------------------------------
 
-////////////////////////////////////////// Hilbert 0 //////////////////////////////////////////
-static int hilbert0 = 0;
-module_param(hilbert0, int, S_IRUGO);
-MODULE_PARM_DESC(hilbert0, " Hilbert transform of waves");
+// A channel with cycles != 0 plays that many periods per trigger and rests.
+// The IP sets a done bit per finished burst and raises its interrupt; the
+// counts below are read by every open /dev/wavegen through read(), poll()
+// and an optional eventfd, so a harness can wait for bursts without spinning.
+// Without an interrupt the done register is polled every millisecond while
+// a burst can be running.
+struct wavegen_burst
+{
+    uint32_t completed[WAVEGEN_MAX_CHANNELS];   // Bursts finished per channel, free running
+    uint32_t armed;                             // Channels triggered and not finished yet
+    struct list_head files;                     // Open files with an eventfd
+    wait_queue_head_t wait;                     // Woken for every finished burst
+    spinlock_t lock;                            // Serializes the fields above
+    struct delayed_work poll;                   // Done register poll without an interrupt
+};
+
+// State of one open /dev/wavegen
+struct wavegen_file
+{
+    uint32_t seen[WAVEGEN_MAX_CHANNELS];        // burst.completed at the last read
+    struct eventfd_ctx *eventfd;                // Signalled once per finished burst, or NULL
+    struct list_head node;                      // In burst.files while eventfd is set
+};
+
+static struct wavegen_burst burst;
 
 /**
- *      @brief Kernel object function to store the hilbert value for channel A
- *      @param kobj
- *      @param attr
- *      @param buffer
- *      @param count
- *      @return ssize_t
+ *      @brief Function to signal an eventfd
+ *      @param eventfd to signal
+ *      @param count to add to the eventfd counter
  **/
-static ssize_t hilbert0Store(struct kobject *kobj, struct kobj_attribute *attr, const char *buffer, size_t count)
+static void burstSignal(struct eventfd_ctx *eventfd, unsigned int count)
 {
-    if (strncmp(buffer, "on", 2) == 0)                           // Channel A
-    {
-        updateHilbert(CHANNEL_A, 1);
-        hilbert0 = 1;
-        printk(KERN_INFO "Hilbert on on Channel A\n");
-    }
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(6, 8, 0)
+    while (count--)
+        eventfd_signal(eventfd);
+#else
+    eventfd_signal(eventfd, count);
+#endif
+}
+
+/**
+ *      @brief Function to collect the done bits of the IP
+ *                (Counts every finished burst, signals the eventfds and
+ *                 wakes readers, safe from the interrupt handler)
+ *      @return uint32_t channels that finished a burst
+ **/
+static uint32_t burstCollect(void)
+{
+    struct wavegen_file *state;
+    unsigned long flags;
+    uint32_t done;
+    unsigned int ch;
 
-    else if (strncmp(buffer, "off", 3) == 0)                    // Channel A
+    done = wavegen.bus->read(wavegen.base, OFS_BURST_DONE) & ((1u << channels) - 1);
+    if (done == 0)
+        return 0;
+
+    // Write 1 to clear, the mock page has no such logic so it is cleared directly
+    wavegen.bus->write(wavegen.base, OFS_BURST_DONE, mock ? 0 : done);
+
+    spin_lock_irqsave(&burst.lock, flags);
+    for (ch = 0; ch < channels; ch++)
     {
-        updateHilbert(CHANNEL_A, 0);
-        hilbert0 = 0;
-        printk(KERN_INFO "Hilbert off on Channel A\n");
+        if (done & (1u << ch))
+            burst.completed[ch]++;
     }
+    burst.armed &= ~done;
 
-    return count;
+    list_for_each_entry(state, &burst.files, node)
+        burstSignal(state->eventfd, hweight32(done));
+    spin_unlock_irqrestore(&burst.lock, flags);
+
+    trace(TRACE_DEBUG, "done %x", done);
+    wake_up_interruptible(&burst.wait);
+    return done;
 }
 
 /**
- *      @brief Kernel object function to get the hilbert value
- *
- *      @param kobj
- *      @param attr
- *      @param buffer
- *      @return ssize_t
+ *      @brief Burst done interrupt handler
+ *      @param irq
+ *      @param param unused
+ *      @return irqreturn_t IRQ_HANDLED when a done bit was set
  **/
-static ssize_t hilbert0Show(struct kobject *kobj, struct kobj_attribute *attr, char *buffer)
+static irqreturn_t burstIrq(int irq, void *param)
 {
-    if      (hilbert0 == 0)   strcpy(buffer, "Hilbert OFF\n");
-    else if (hilbert0 == 1)   strcpy(buffer, "Hilbert ON\n");
-
-    return strlen(buffer);
+    return burstCollect() ? IRQ_HANDLED : IRQ_NONE;
 }
 
-static struct kobj_attribute hilbert0Attr = __ATTR(hilbert0, 0664, hilbert0Show, hilbert0Store);
-
+/**
+ *      @brief Work function polling the done register without an interrupt
+ *      @param work
+ **/
+static void burstPoll(struct work_struct *work)
+{
+    unsigned long flags;
+    uint32_t waiting;
 
+    burstCollect();
 
+    spin_lock_irqsave(&burst.lock, flags);
+    waiting = burst.armed | readRegister(&wavegen, OFS_TRIGGER_EXT);
+    spin_unlock_irqrestore(&burst.lock, flags);
 
-////////////////////////////////////////// Hilbert 1 //////////////////////////////////////////
-static int hilbert1 = 0;
-module_param(hilbert1, int, S_IRUGO);
-MODULE_PARM_DESC(hilbert1, " Hilbert transform of waves");
+    if (waiting)
+        schedule_delayed_work(&burst.poll, msecs_to_jiffies(1));
+}
 
 /**
- *      @brief Kernel object function to store the hilbert value for channel B
- *      @param kobj
- *      @param attr
- *      @param buffer
- *      @param count
- *      @return ssize_t
+ *      @brief Function to start a burst on every channel in a mask
+ *                (Channels with cycles = 0 run continuously and ignore it)
+ *      @param mask bit n = channel n
  **/
-static ssize_t hilbert1Store(struct kobject *kobj, struct kobj_attribute *attr, const char *buffer, size_t count)
+static void burstTrigger(uint32_t mask)
 {
-    if (strncmp(buffer, "on", 2) == 0)                           // Channel A
-    {
-        updateHilbert(CHANNEL_B, 1);
-        hilbert1 = 1;
-        printk(KERN_INFO "Hilbert on on Channel B\n");
-    }
+    unsigned long flags;
+    unsigned int ch;
 
-    else if (strncmp(buffer, "off", 3) == 0)                    // Channel A
+    mask &= (1u << channels) - 1;
+    for (ch = 0; ch < channels; ch++)
     {
-        updateHilbert(CHANNEL_B, 0);
-        hilbert1 = 0;
-        printk(KERN_INFO "Hilbert off on Channel B\n");
+        if (readRegister(&wavegen, OFS_CH(ch, OFS_CH_CYCLES)) == 0)
+            mask &= ~(1u << ch);
     }
+    if (mask == 0)
+        return;
 
-    return count;
+    spin_lock_irqsave(&burst.lock, flags);
+    burst.armed |= mask;
+    spin_unlock_irqrestore(&burst.lock, flags);
+
+    wavegen.bus->write(wavegen.base, OFS_TRIGGER, mask);
+    trace(TRACE_INFO, "Trigger %x", mask);
+
+    // The mock page finishes every burst at once
+    if (mock)
+        wavegen.bus->write(wavegen.base, OFS_BURST_DONE, wavegen.bus->read(wavegen.base, OFS_BURST_DONE) | mask);
+
+    if (irq <= 0)
+        mod_delayed_work(system_wq, &burst.poll, 0);
 }
 
 /**
- *      @brief Kernel object function to get the hilbert value
- *
- *      @param kobj
- *      @param attr
- *      @param buffer
- *      @return ssize_t
+ *      @brief Function to update the channels started by the external trigger
+ *      @param clear channels to stop following the trigger
+ *      @param set channels to start following the trigger
  **/
-static ssize_t hilbert1Show(struct kobject *kobj, struct kobj_attribute *attr, char *buffer)
+static void burstSetExternal(uint32_t clear, uint32_t set)
 {
-    if      (hilbert1 == 0)   strcpy(buffer, "Hilbert OFF\n");
-    else if (hilbert1 == 1)   strcpy(buffer, "Hilbert ON\n");
+    modifyRegister(&wavegen, OFS_TRIGGER_EXT, clear, set & ((1u << channels) - 1));
 
-    return strlen(buffer);
+    if (irq <= 0)
+        mod_delayed_work(system_wq, &burst.poll, 0);
 }
 
-static struct kobj_attribute hilbert1Attr = __ATTR(hilbert1, 0664, hilbert1Show, hilbert1Store);
-
-
-////////////////////////////////////////// Run 0 //////////////////////////////////////////
-static int run0 = 0;
-module_param(run0, int, S_IRUGO);
-MODULE_PARM_DESC(run0, " Run waves");
-
 /**
- *      @brief Kernel object function to store the run value for channel A
- *      @param kobj
- *      @param attr
- *      @param buffer
- *      @param count
- *      @return ssize_t
+ *      @brief Function to check for bursts a file has not read yet
+ *      @param state of the open file
+ *      @return bool true when a channel finished a burst since the last read
  **/
-static ssize_t run0Store(struct kobject *kobj, struct kobj_attribute *attr, const char *buffer, size_t count)
+static bool burstPending(const struct wavegen_file *state)
 {
-    if (strncmp(buffer, "a", 1) == 0)                           // Channel A
-    {
-        updateRun(CHANNEL_A, 1);
-        run0 = 0;
-        printk(KERN_INFO "Running A\n");
-    }
-
-    else if (strncmp(buffer, "c", 1) == 0)                      // Channel A+B
-    {
-        updateRun(CHANNEL_AB, 1);
-        run0 = 2;
-        printk(KERN_INFO "Running A+B\n");
-    }
+    unsigned int ch;
 
-    else if (strncmp(buffer, "stop", strlen("stop")) == 0) // Clear Channel A+B
+    for (ch = 0; ch < channels; ch++)
     {
-        updateRun(CHANNEL_AB, 0);
-        run0 = 1;
-        printk(KERN_INFO "Stopped A+B\n");
+        if (READ_ONCE(burst.completed[ch]) != state->seen[ch])
+            return true;
     }
-    return count;
+    return false;
 }
 
+//-----------------------------------------------------------------------------
+// Kernel Objects
+//-----------------------------------------------------------------------------
+
+// One directory per channel, /sys/kernel/wavegen/[channel], holding
+// mode[channel], run[channel], ... so channel 0 and 1 keep their old paths
+#define CHANNEL_ATTRS 11
+
+struct wavegen_channel
+{
+    int mode, run, comp, hilbert;                   // Last values written through sysfs or ioctl
+    unsigned int frequency;
+    int offset, amplitude, duty, cycles, phase;
+
+    char groupName[4];                              // [channel]
+    char names[CHANNEL_ATTRS][16];                  // mode[channel], run[channel], ...
+    struct kobj_attribute attrs[CHANNEL_ATTRS];
+    struct attribute *attrList[CHANNEL_ATTRS + 1];
+    struct attribute_group group;
+};
+
+static struct wavegen_channel channelState[WAVEGEN_MAX_CHANNELS];
+
+static const char *const modeNames[]  = { "dc", "sine", "saw", "tri", "sq", "arb", "stream" };
+static const char *const modeLabels[] = { "DC", "Sine", "Sawtooth", "Triangle", "Square", "Arbitrary", "Stream" };
+
 /**
- *      @brief Kernel object function to get the run value
- *
- *      @param kobj
- *      @param attr
- *      @param buffer
- *      @return ssize_t
+ *      @brief Function to find the channel an attribute belongs to
+ *      @param attr attribute of a channel directory
+ *      @return int channel
  **/
-static ssize_t run0Show(struct kobject *kobj, struct kobj_attribute *attr, char *buffer)
+static int channelOf(struct kobj_attribute *attr)
 {
-    if      (run0 == 0)   strcpy(buffer, "Channel A\n");
-    else if (run0 == 2)   strcpy(buffer, "Channel A+B\n");
-
-    return strlen(buffer);
-}
+    unsigned int i;
 
-static struct kobj_attribute run0Attr = __ATTR(run0, 0664, run0Show, run0Store);
+    for (i = 0; i < channels; i++)
+    {
+        if (attr >= channelState[i].attrs && attr < channelState[i].attrs + CHANNEL_ATTRS)
+            return i;
+    }
 
-////////////////////////////////////////// Run 1 //////////////////////////////////////////
-static int run1 = 0;
-module_param(run1, int, S_IRUGO);
-MODULE_PARM_DESC(run1, " Run waves");
+    return 0;
+}
 
+////////////////////////////////////////// Hilbert //////////////////////////////////////////
 /**
- *      @brief Kernel object function to store the run value for channel B
+ *      @brief Kernel object function to store the hilbert value of a channel
  *      @param kobj
  *      @param attr
  *      @param buffer
  *      @param count
  *      @return ssize_t
  **/
-static ssize_t run1Store(struct kobject *kobj, struct kobj_attribute *attr, const char *buffer, size_t count)
+static ssize_t hilbertStore(struct kobject *kobj, struct kobj_attribute *attr, const char *buffer, size_t count)
 {
-    if (strncmp(buffer, "b", 1) == 0)                           // Channel B
-    {
-        updateRun(CHANNEL_B, 1);
-        run1 = 0;
-        printk(KERN_INFO "Running B\n");
-    }
+    int channel = channelOf(attr);
 
-    else if (strncmp(buffer, "c", 1) == 0)                      // Channel A+B
+    if (strncmp(buffer, "on", 2) == 0)
     {
-        updateRun(CHANNEL_AB, 1);
-        run1 = 2;
-        printk(KERN_INFO "Running A+B\n");
+        updateHilbert(channel, 1);
+        channelState[channel].hilbert = 1;
+        trace(TRACE_INFO, "Hilbert on on Channel %d", channel);
     }
 
-    else if (strncmp(buffer, "stop", strlen("stop")) == 0) // Clear Channel A+B
+    else if (strncmp(buffer, "off", 3) == 0)
     {
-        updateRun(CHANNEL_AB, 0);
-        run1 = 1;
-        printk(KERN_INFO "Stopped A+B\n");
+        updateHilbert(channel, 0);
+        channelState[channel].hilbert = 0;
+        trace(TRACE_INFO, "Hilbert off on Channel %d", channel);
     }
+
     return count;
 }
 
 /**
- *      @brief Kernel object function to get the run value
+ *      @brief Kernel object function to get the hilbert value
  *
  *      @param kobj
  *      @param attr
  *      @param buffer
  *      @return ssize_t
  **/
-static ssize_t run1Show(struct kobject *kobj, struct kobj_attribute *attr, char *buffer)
+static ssize_t hilbertShow(struct kobject *kobj, struct kobj_attribute *attr, char *buffer)
 {
-    if (run1 == 0)      strcpy(buffer, "Channel B\n");
-    else if (run1 == 2) strcpy(buffer, "Channel A+B\n");
+    if (channelState[channelOf(attr)].hilbert)  strcpy(buffer, "Hilbert ON\n");
+    else                                        strcpy(buffer, "Hilbert OFF\n");
 
     return strlen(buffer);
 }
 
-static struct kobj_attribute run1Attr = __ATTR(run1, 0664, run1Show, run1Store);
-
-
-////////////////////////////////////////// Complementary 0 //////////////////////////////////////////
-static int comp0 = 0;
-module_param(comp0, int, S_IRUGO);
-MODULE_PARM_DESC(comp0, " Complement Waves");
-
+////////////////////////////////////////// Run //////////////////////////////////////////
 /**
- *      @brief Kernel object function to store the complement logic value for channel A
+ *      @brief Kernel object function to store the run value of a channel
+ *                ("a", "b", ... or "on" runs this channel, "off" stops it,
+ *                 "c" runs and "stop" stops every channel at once)
  *      @param kobj
  *      @param attr
  *      @param buffer
  *      @param count
  *      @return ssize_t
  **/
-static ssize_t comp0Store(struct kobject *kobj, struct kobj_attribute *attr, const char *buffer, size_t count)
+static ssize_t runStore(struct kobject *kobj, struct kobj_attribute *attr, const char *buffer, size_t count)
 {
-    if (strncmp(buffer, "on", 2) == 0)                              // On
+    int channel = channelOf(attr);
+    unsigned int i;
+
+    if (buffer[0] == 'a' + channel || strncmp(buffer, "on", 2) == 0)     // This channel
     {
-        updateComplement(CHANNEL_A, 1);
-        comp0 = 0;
-        printk(KERN_INFO "Complementing A with B\n");
+        updateRun(channel, 1);
+        channelState[channel].run = 1;
+        trace(TRACE_INFO, "Running %c", 'A' + channel);
     }
 
-    else if (strncmp(buffer, "off", 3) == 0)                        // Off
+    else if (strncmp(buffer, "off", 3) == 0)                            // Clear this channel
+    {
+        updateRun(channel, 0);
+        channelState[channel].run = 0;
+        trace(TRACE_INFO, "Stopped %c", 'A' + channel);
+    }
+
+    else if (strncmp(buffer, "c", 1) == 0)                              // Every channel
+    {
+        updateRun(CHANNEL_ALL, 1);
+        for (i = 0; i < channels; i++)
+            channelState[i].run = 2;
+        trace(TRACE_INFO, "Running all");
+    }
+
+    else if (strncmp(buffer, "stop", strlen("stop")) == 0)              // Clear every channel
     {
-        updateComplement(CHANNEL_A, 0);
-        comp0 = 0;
-        printk(KERN_INFO "Independent waves on A and B\n");
+        updateRun(CHANNEL_ALL, 0);
+        for (i = 0; i < channels; i++)
+            channelState[i].run = 0;
+        trace(TRACE_INFO, "Stopped all");
     }
     return count;
 }
 
 /**
- *      @brief Kernel object function to get the complement value
+ *      @brief Kernel object function to get the run value
  *
  *      @param kobj
  *      @param attr
  *      @param buffer
  *      @return ssize_t
  **/
-static ssize_t comp0Show(struct kobject *kobj, struct kobj_attribute *attr, char *buffer)
+static ssize_t runShow(struct kobject *kobj, struct kobj_attribute *attr, char *buffer)
 {
-    if (comp0 == 1)      strcpy(buffer, "Complementing A with B\n");
-    else if (comp0 == 0) strcpy(buffer, "Independent waves\n");
+    int channel = channelOf(attr);
+
+    if      (channelState[channel].run == 1)    sprintf(buffer, "Channel %c\n", 'A' + channel);
+    else if (channelState[channel].run == 2)    strcpy(buffer, "All channels\n");
+    else                                        strcpy(buffer, "Stopped\n");
 
     return strlen(buffer);
 }
 
-static struct kobj_attribute comp0Attr = __ATTR(comp0, 0664, comp0Show, comp0Store);
-
-
-
-////////////////////////////////////////// Complementary 1 //////////////////////////////////////////
-static int comp1 = 0;
-module_param(comp1, int, S_IRUGO);
-MODULE_PARM_DESC(comp1, " Complement Waves");
-
+////////////////////////////////////////// Complementary //////////////////////////////////////////
 /**
- *      @brief Kernel object function to store the complement logic value for channel B
+ *      @brief Kernel object function to store the complement logic value of a channel
  *      @param kobj
  *      @param attr
  *      @param buffer
  *      @param count
  *      @return ssize_t
  **/
-static ssize_t comp1Store(struct kobject *kobj, struct kobj_attribute *attr, const char *buffer, size_t count)
+static ssize_t compStore(struct kobject *kobj, struct kobj_attribute *attr, const char *buffer, size_t count)
 {
+    int channel = channelOf(attr);
+
     if (strncmp(buffer, "on", 2) == 0)                              // On
     {
-        updateComplement(CHANNEL_B, 1);
-        comp0 = 0;
-        printk(KERN_INFO "Complementing B with A\n");
+        updateComplement(channel, 1);
+        channelState[channel].comp = 1;
+        trace(TRACE_INFO, "Complementing %c with %c", 'A' + channel, 'A' + (channel ^ 1));
     }
 
     else if (strncmp(buffer, "off", 3) == 0)                        // Off
     {
-        updateComplement(CHANNEL_B, 0);
-        comp0 = 0;
-        printk(KERN_INFO "Independent waves on A and B\n");
+        updateComplement(channel, 0);
+        channelState[channel].comp = 0;
+        trace(TRACE_INFO, "Independent waves on %c and %c", 'A' + channel, 'A' + (channel ^ 1));
     }
     return count;
 }
@@ -687,244 +669,176 @@ static ssize_t comp1Store(struct kobject *kobj, struct kobj_attribute *attr, con
  *      @param buffer
  *      @return ssize_t
  **/
-static ssize_t comp1Show(struct kobject *kobj, struct kobj_attribute *attr, char *buffer)
+static ssize_t compShow(struct kobject *kobj, struct kobj_attribute *attr, char *buffer)
 {
-    if (comp1 == 1)      strcpy(buffer, "Complementing B with A\n");
-    else if (comp1 == 0) strcpy(buffer, "Independent waves\n");
+    int channel = channelOf(attr);
+
+    if (channelState[channel].comp) sprintf(buffer, "Complementing %c with %c\n", 'A' + channel, 'A' + (channel ^ 1));
+    else                            strcpy(buffer, "Independent waves\n");
 
     return strlen(buffer);
 }
 
-static struct kobj_attribute comp1Attr = __ATTR(comp1, 0664, comp1Show, comp1Store);
-
-
-
-////////////////////////////////////////// Mode 0 //////////////////////////////////////////
-static int mode0 = 0;
-// module_param(mode0, bool, S_IRUGO);
-MODULE_PARM_DESC(mode0, " Mode of channel A");
-
+////////////////////////////////////////// Mode //////////////////////////////////////////
 /**
-*      @brief Kernel Object function to set the mode register for channel A
+*      @brief Kernel Object function to set the mode of a channel
 *      @param kobj
 *      @param attr
 *      @param buffer
 *      @param count
 *      @return ssize_t
 **/
-static ssize_t mode0Store(struct kobject *kobj, struct kobj_attribute *attr, const char *buffer, size_t count)
+static ssize_t modeStore(struct kobject *kobj, struct kobj_attribute *attr, const char *buffer, size_t count)
 {
-    if (strncmp(buffer, "dc", strlen("dc")) == 0)
-    {
-        mode0 = MODE_DC;
-        updateMode(CHANNEL_A, MODE_DC);
-    }
-    if (strncmp(buffer, "sine", strlen("sine")) == 0)
-    {
-        mode0 = MODE_SIN;
-        updateMode(CHANNEL_A, MODE_SIN);
-    }
-    if (strncmp(buffer, "saw", strlen("saw")) == 0)
-    {
-        mode0 = MODE_SAW;
-        updateMode(CHANNEL_A, MODE_SAW);
-    }
-    if (strncmp(buffer, "tri", strlen("tri")) == 0)
-    {
-        mode0 = MODE_TRI;
-        updateMode(CHANNEL_A, MODE_TRI);
-    }
-    if (strncmp(buffer, "sq", strlen("sq")) == 0)
+    int channel = channelOf(attr);
+    unsigned int i;
+
+    for (i = 0; i <= MODE_STREAM; i++)
     {
-        mode0 = MODE_SQR;
-        updateMode(CHANNEL_A, MODE_SQR);
+        if (strncmp(buffer, modeNames[i], strlen(modeNames[i])) == 0)
+        {
+            channelState[channel].mode = i;
+            updateMode(channel, i);
+        }
     }
 
     return count;
 }
 
 /**
- *      @brief Kernel object function to get the mode value for channel A
+ *      @brief Kernel object function to get the mode of a channel
  *      @param kobj
  *      @param attr
  *      @param buffer
  *      @return ssize_t
  **/
-static ssize_t mode0Show(struct kobject *kobj, struct kobj_attribute *attr, char *buffer)
+static ssize_t modeShow(struct kobject *kobj, struct kobj_attribute *attr, char *buffer)
 {
-    mode0 = getMode();
+    unsigned int mode = getMode(channelOf(attr));
 
-    if      (mode0 & 0x07 & MODE_DC)    strcpy(buffer, "DC\n");
-    else if (mode0 & 0x07 & MODE_SIN)   strcpy(buffer, "Sine\n");
-    else if (mode0 & 0x07 & MODE_SAW)   strcpy(buffer, "Sawtooth\n");
-    else if (mode0 & 0x07 & MODE_TRI)   strcpy(buffer, "Triangle\n");
-    else if (mode0 & 0x07 & MODE_SQR)   strcpy(buffer, "Square\n");
+    if (mode <= MODE_STREAM)    sprintf(buffer, "%s\n", modeLabels[mode]);
+    else                        strcpy(buffer, "\n");
 
     return strlen(buffer);
 }
 
-static struct kobj_attribute mode0Attr = __ATTR(mode0, 0664, mode0Show, mode0Store);
-
-
-
-////////////////////////////////////////// Mode 1 //////////////////////////////////////////
-static int mode1 = 0;
-MODULE_PARM_DESC(mode1, " Mode of channel B");
-
+////////////////////////////////////////// Frequency //////////////////////////////////////////
 /**
-*      @brief Kernel Object function to set the mode register for channel B
-*      @param kobj
-*      @param attr
-*      @param buffer
-*      @param count
-*      @return ssize_t
-**/
-static ssize_t mode1Store(struct kobject *kobj, struct kobj_attribute *attr, const char *buffer, size_t count)
+ *      @brief Kernel object function to update the frequency register of a channel
+ *      @param kobj
+ *      @param attr
+ *      @param buffer
+ *      @param count
+ *      @return ssize_t
+ **/
+static ssize_t frequencyStore(struct kobject *kobj, struct kobj_attribute *attr, const char *buffer, size_t count)
 {
-    if (strncmp(buffer, "dc", strlen("dc")) == 0)
-    {
-        mode1 = MODE_DC;
-        updateMode(CHANNEL_B, MODE_DC);
-    }
-    if (strncmp(buffer, "sine", strlen("sine")) == 0)
-    {
-        mode1 = MODE_SIN;
-        updateMode(CHANNEL_B, MODE_SIN);
-    }
-    if (strncmp(buffer, "saw", strlen("saw")) == 0)
-    {
-        mode1 = MODE_SAW;
-        updateMode(CHANNEL_B, MODE_SAW);
-    }
-    if (strncmp(buffer, "tri", strlen("tri")) == 0)
-    {
-        mode1 = MODE_TRI;
-        updateMode(CHANNEL_B, MODE_TRI);
-    }
-    if (strncmp(buffer, "sq", strlen("sq")) == 0)
-    {
-        mode1 = MODE_SQR;
-        updateMode(CHANNEL_B, MODE_SQR);
-    }
+    int channel = channelOf(attr);
+    uint32_t result = kstrtouint(buffer, 0, &channelState[channel].frequency);
+
+    if (!result)    updateFrequency(channel, channelState[channel].frequency);
 
     return count;
 }
 
 /**
- *      @brief Kernel object function to get the mode value for channel A
+ *      @brief Kernel object function to read the frequency register of a channel
+ *
  *      @param kobj
  *      @param attr
  *      @param buffer
  *      @return ssize_t
  **/
-static ssize_t mode1Show(struct kobject *kobj, struct kobj_attribute *attr, char *buffer)
+static ssize_t frequencyShow(struct kobject *kobj, struct kobj_attribute *attr, char *buffer)
 {
-    mode1 = getMode();
-
-    if      (mode1 & 0x56 & MODE_DC)    strcpy(buffer, "DC\n");
-    else if (mode1 & 0x56 & MODE_SIN)   strcpy(buffer, "Sine\n");
-    else if (mode1 & 0x56 & MODE_SAW)   strcpy(buffer, "Sawtooth\n");
-    else if (mode1 & 0x56 & MODE_TRI)   strcpy(buffer, "Triangle\n");
-    else if (mode1 & 0x56 & MODE_SQR)   strcpy(buffer, "Square\n");
+    uint32_t result;
+    result = getFrequency(channelOf(attr));
 
-    return strlen(buffer);
+    return sprintf(buffer, "%d\n", result);
 }
 
-static struct kobj_attribute mode1Attr = __ATTR(mode1, 0664, mode1Show, mode1Store);
-
-
-
-////////////////////////////////////////// Frequency 0 //////////////////////////////////////////
-static int frequency0 = 0;
-// module_param(frequency0, int, S_IRUGO);
-MODULE_PARM_DESC(frequency0, " Frequency of Channel A");
-
+////////////////////////////////////////// Offset //////////////////////////////////////////
 /**
- *      @brief Kernel object function to update the frequency register for channel A
+ *      @brief kernel object function to set the offset register
+ *
  *      @param kobj
  *      @param attr
  *      @param buffer
  *      @param count
  *      @return ssize_t
  **/
-static ssize_t frequency0Store(struct kobject *kobj, struct kobj_attribute *attr, const char *buffer, size_t count)
+static ssize_t offsetStore(struct kobject *kobj, struct kobj_attribute *attr, const char *buffer, size_t count)
 {
-    uint32_t result = kstrtouint(buffer, 0, &frequency0);
+    int channel = channelOf(attr);
+    int32_t signedScaled;
+    sscanf(buffer, "%d", &channelState[channel].offset);
+
+    signedScaled = (signAndScale(channelState[channel].offset, 2500) & 0x0000FFFF);
+
+    trace(TRACE_INFO, "Set: %d", signedScaled);
 
-    if (!result)    updateFrequency(CHANNEL_A, frequency0);
+    updateOffset(channel, signedScaled);
 
     return count;
 }
 
 /**
- *      @brief Kernel object function to read the frequency register for Channel A
+ *      @brief Kernel object function to read the offset of a channel
  *
  *      @param kobj
  *      @param attr
  *      @param buffer
  *      @return ssize_t
  **/
-static ssize_t frequency0Show(struct kobject *kobj, struct kobj_attribute *attr, char *buffer)
+static ssize_t offsetShow(struct kobject *kobj, struct kobj_attribute *attr, char *buffer)
 {
-    uint32_t result;
-    result = getFrequency(CHANNEL_A);
+    sprintf(buffer, "%d\n", channelState[channelOf(attr)].offset);
 
-    return sprintf(buffer, "%d\n", result);
+    return strlen(buffer);
 }
 
-static struct kobj_attribute frequency0Attr = __ATTR(frequency0, 0664, frequency0Show, frequency0Store);
-
-
-
-////////////////////////////////////////// Frequency 1 //////////////////////////////////////////
-static int frequency1 = 0;
-// module_param(frequency1, int, S_IRUGO);
-MODULE_PARM_DESC(frequency1, " Frequency of Channel B");
-
+////////////////////////////////////////// Amplitude //////////////////////////////////////////
 /**
- *      @brief Kernel object function to update the frequency register for channel B
+ *      @brief Kernel object function to set the Amplitude register of a channel
+ *
  *      @param kobj
  *      @param attr
  *      @param buffer
  *      @param count
  *      @return ssize_t
  **/
-static ssize_t frequency1Store(struct kobject *kobj, struct kobj_attribute *attr, const char *buffer, size_t count)
+static ssize_t amplitudeStore(struct kobject *kobj, struct kobj_attribute *attr, const char *buffer, size_t count)
 {
-    uint32_t result = kstrtouint(buffer, 0, &frequency1);
+    int channel = channelOf(attr);
+    int32_t signedScaled;
+    sscanf(buffer, "%d", &channelState[channel].amplitude);
+
+    signedScaled = (signAndScale(channelState[channel].amplitude, 2500) & 0x0000FFFF);
 
-    if (!result)    updateFrequency(CHANNEL_B, frequency1);
+    trace(TRACE_INFO, "Set: %d", signedScaled);
 
+    updateAmplitude(channel, signedScaled);
     return count;
 }
 
 /**
- *      @brief Kernel object function to read the frequency register for Channel B
+ *      @brief Kernel object function to read the Amplitude of a channel
+ *
  *      @param kobj
  *      @param attr
  *      @param buffer
  *      @return ssize_t
  **/
-static ssize_t frequency1Show(struct kobject *kobj, struct kobj_attribute *attr, char *buffer)
+static ssize_t amplitudeShow(struct kobject *kobj, struct kobj_attribute *attr, char *buffer)
 {
-    uint32_t result;
-    result = getFrequency(CHANNEL_B);
+    sprintf(buffer, "%d\n", channelState[channelOf(attr)].amplitude);
 
-    return sprintf(buffer, "%d\n", result);
+    return strlen(buffer);
 }
 
-static struct kobj_attribute frequency1Attr = __ATTR(frequency1, 0664, frequency1Show, frequency1Store);
-
-
-
-
-////////////////////////////////////////// Offset 0 //////////////////////////////////////////
-static int offset0 = 0;
-// module_param(offset0, float, S_IRUGO);
-MODULE_PARM_DESC(offset0, " Offset of Channel A");
-
+////////////////////////////////////////// Duty Cycles //////////////////////////////////////////
 /**
- *      @brief kernel object function to set the offset register
+ *      @brief Kernel object function to set the Duty cycles register of a channel
  *
  *      @param kobj
  *      @param attr
@@ -932,49 +846,38 @@ MODULE_PARM_DESC(offset0, " Offset of Channel A");
  *      @param count
  *      @return ssize_t
  **/
-static ssize_t offset0Store(struct kobject *kobj, struct kobj_attribute *attr, const char *buffer, size_t count)
+static ssize_t dutyStore(struct kobject *kobj, struct kobj_attribute *attr, const char *buffer, size_t count)
 {
+    int channel = channelOf(attr);
     int32_t signedScaled;
-    sscanf(buffer, "%d", &offset0);
-
-    signedScaled = (signAndScale(offset0, 2500) & 0x0000FFFF);
+    sscanf(buffer, "%d", &channelState[channel].duty);
 
-    printk(KERN_INFO "Set: %d\n", signedScaled);
+    signedScaled = (uint32_t)signAndScale(channelState[channel].duty, 100);
 
-    updateOffset(CHANNEL_A, signedScaled);
+    trace(TRACE_INFO, "Set: %d", signedScaled);
 
+    updateDutyCycles(channel, signedScaled);
     return count;
 }
 
 /**
- *      @brief Kernel object function to read offset register for Channel A
+ *      @brief Kernel object function to read the Duty Cycles of a channel
  *
  *      @param kobj
  *      @param attr
  *      @param buffer
  *      @return ssize_t
  **/
-static ssize_t offset0Show(struct kobject *kobj, struct kobj_attribute *attr, char *buffer)
+static ssize_t dutyShow(struct kobject *kobj, struct kobj_attribute *attr, char *buffer)
 {
-    int channelA_offset;
-
-    channelA_offset = getOffset();
-
-    sprintf(buffer, "%d\n", offset0);
+    sprintf(buffer, "%d", channelState[channelOf(attr)].duty);
 
     return strlen(buffer);
 }
 
-static struct kobj_attribute offset0Attr = __ATTR(offset0, 0664, offset0Show, offset0Store);
-
-
-////////////////////////////////////////// Offset 1 //////////////////////////////////////////
-static int offset1 = 0;
-// module_param(offset1, float, S_IRUGO);
-MODULE_PARM_DESC(offset1, " Offset of Channel B");
-
+////////////////////////////////////////// Cycles //////////////////////////////////////////
 /**
- *      @brief kernel object function to set the offset register
+ *      @brief Kernel object function to set the Cycles register of a channel
  *
  *      @param kobj
  *      @param attr
@@ -982,447 +885,859 @@ MODULE_PARM_DESC(offset1, " Offset of Channel B");
  *      @param count
  *      @return ssize_t
  **/
-static ssize_t offset1Store(struct kobject *kobj, struct kobj_attribute *attr, const char *buffer, size_t count)
+static ssize_t cyclesStore(struct kobject *kobj, struct kobj_attribute *attr, const char *buffer, size_t count)
 {
-    int32_t signedScaled;
-    sscanf(buffer, "%d", &offset1);
-
-    signedScaled = signAndScale(offset1, 2500);
+    int channel = channelOf(attr);
+    sscanf(buffer, "%d", &channelState[channel].cycles);
 
-    printk(KERN_INFO "Set: %d\n", signedScaled);
-
-    updateOffset(CHANNEL_B, signedScaled);
+    trace(TRACE_INFO, "Set: %d", channelState[channel].cycles);
 
+    updateCycles(channel, channelState[channel].cycles);
     return count;
 }
 
 /**
- *      @brief Kernel object function to read offset register for Channel A
+ *      @brief Kernel object function to read the Cycles of a channel
  *
  *      @param kobj
  *      @param attr
  *      @param buffer
  *      @return ssize_t
  **/
-static ssize_t offset1Show(struct kobject *kobj, struct kobj_attribute *attr, char *buffer)
+static ssize_t cyclesShow(struct kobject *kobj, struct kobj_attribute *attr, char *buffer)
 {
-    int channelA_offset;
-
-    channelA_offset = getOffset();
-
-    sprintf(buffer, "%d\n", offset1);
+    sprintf(buffer, "%d", channelState[channelOf(attr)].cycles);
 
     return strlen(buffer);
 }
 
-static struct kobj_attribute offset1Attr = __ATTR(offset1, 0664, offset1Show, offset1Store);
-
-
-
-////////////////////////////////////////// Amplitude 0 //////////////////////////////////////////
-static int amplitude0 = 0;
-// module_param(amplitude0, float, S_IRUGO);
-MODULE_PARM_DESC(amplitude0, " Amplitude of Channel A");
-
+////////////////////////////////////////// Phase //////////////////////////////////////////
 /**
- *      @brief Kernel object function to set the Amplitude register on channel A
- *
+ *      @brief Function to set the phase value of a channel
  *      @param kobj
  *      @param attr
  *      @param buffer
  *      @param count
  *      @return ssize_t
  **/
-static ssize_t amplitude0Store(struct kobject *kobj, struct kobj_attribute *attr, const char *buffer, size_t count)
+static ssize_t phaseStore(struct kobject *kobj, struct kobj_attribute *attr, const char *buffer, size_t count)
 {
-    int32_t signedScaled;
-    sscanf(buffer, "%d", &amplitude0);
+    int channel = channelOf(attr);
+    uint32_t signedScaled;
+
+    sscanf(buffer, "%d", &channelState[channel].phase);
+
+    signedScaled = (channelState[channel].phase * 65536) / 360;                    // 2^16 = 360 degrees
 
-    signedScaled = (signAndScale(amplitude0, 2500) & 0x0000FFFF);
+    trace(TRACE_INFO, "Set: %d", channelState[channel].phase);
 
-    printk(KERN_INFO "Set: %d\n", signedScaled);
+    updatePhase(channel, signedScaled);
 
-    updateAmplitude(CHANNEL_A, signedScaled);
     return count;
 }
 
 /**
- *      @brief Kernel object function to read Amplitude register for Channel A
- *
+ *      @brief Function to read the phase value of a channel
  *      @param kobj
  *      @param attr
  *      @param buffer
  *      @return ssize_t
  **/
-static ssize_t amplitude0Show(struct kobject *kobj, struct kobj_attribute *attr, char *buffer)
+static ssize_t phaseShow(struct kobject *kobj, struct kobj_attribute *attr, char *buffer)
 {
-    sprintf(buffer, "%d\n", amplitude0);
+    sprintf(buffer, "%d", channelState[channelOf(attr)].phase);
 
     return strlen(buffer);
 }
 
-static struct kobj_attribute amplitude0Attr = __ATTR(amplitude0, 0664, amplitude0Show, amplitude0Store);
-
-
-////////////////////////////////////////// Amplitude 1 //////////////////////////////////////////
-static int amplitude1 = 0;
-// module_param(amplitude1, float, S_IRUGO);
-MODULE_PARM_DESC(amplitude1, " Amplitude of Channel B");
-
+////////////////////////////////////////// External Trigger //////////////////////////////////////////
 /**
- *      @brief Kernel object function to set the Amplitude register on channel B
- *
+ *      @brief Kernel object function to make a channel follow the external trigger
  *      @param kobj
  *      @param attr
- *      @param buffer
+ *      @param buffer "on" or "off"
  *      @param count
  *      @return ssize_t
  **/
-static ssize_t amplitude1Store(struct kobject *kobj, struct kobj_attribute *attr, const char *buffer, size_t count)
+static ssize_t extrigStore(struct kobject *kobj, struct kobj_attribute *attr, const char *buffer, size_t count)
 {
-    int32_t signedScaled;
-    sscanf(buffer, "%d", &amplitude1);
+    int channel = channelOf(attr);
 
-    signedScaled = signAndScale(amplitude1, 2500);
+    if      (strncmp(buffer, "on", 2) == 0)     burstSetExternal(0, 1u << channel);
+    else if (strncmp(buffer, "off", 3) == 0)    burstSetExternal(1u << channel, 0);
 
-    printk(KERN_INFO "Set: %d\n", signedScaled);
-
-    updateAmplitude(CHANNEL_B, signedScaled);
     return count;
 }
 
 /**
- *      @brief Kernel object function to read Amplitude register for Channel B
- *
+ *      @brief Kernel object function to read the external trigger enable of a channel
  *      @param kobj
  *      @param attr
  *      @param buffer
  *      @return ssize_t
  **/
-static ssize_t amplitude1Show(struct kobject *kobj, struct kobj_attribute *attr, char *buffer)
+static ssize_t extrigShow(struct kobject *kobj, struct kobj_attribute *attr, char *buffer)
 {
-    sprintf(buffer, "%d\n", amplitude1);
+    if (readRegister(&wavegen, OFS_TRIGGER_EXT) & (1u << channelOf(attr)))  strcpy(buffer, "on\n");
+    else                                                                    strcpy(buffer, "off\n");
 
     return strlen(buffer);
 }
 
-static struct kobj_attribute amplitude1Attr = __ATTR(amplitude1, 0664, amplitude1Show, amplitude1Store);
+// Attributes of every channel directory, named [name][channel]
+static const struct
+{
+    const char *name;
+    ssize_t (*show)(struct kobject *kobj, struct kobj_attribute *attr, char *buffer);
+    ssize_t (*store)(struct kobject *kobj, struct kobj_attribute *attr, const char *buffer, size_t count);
+} channelAttrs[CHANNEL_ATTRS] =
+    {
+        { "mode",       modeShow,       modeStore },
+        { "run",        runShow,        runStore },
+        { "amplitude",  amplitudeShow,  amplitudeStore },
+        { "offset",     offsetShow,     offsetStore },
+        { "duty",       dutyShow,       dutyStore },
+        { "cycles",     cyclesShow,     cyclesStore },
+        { "frequency",  frequencyShow,  frequencyStore },
+        { "phase",      phaseShow,      phaseStore },
+        { "comp",       compShow,       compStore },
+        { "hilbert",    hilbertShow,    hilbertStore },
+        { "extrig",     extrigShow,     extrigStore },
+    };
 
+////////////////////////////////////////// Trace //////////////////////////////////////////
+struct wavegen_trace wavegenTrace;
 
+/**
+ *      @brief Kernel object function to dump the trace ring
+ *                (Empty unless built with WAVEGEN_TRACE_LEVEL > 0)
+ *      @param kobj
+ *      @param attr
+ *      @param buffer
+ *      @return ssize_t
+ **/
+static ssize_t traceShow(struct kobject *kobj, struct kobj_attribute *attr, char *buffer)
+{
+    uint32_t i, last = traceLast(&wavegenTrace);
+    ssize_t length = 0;
+
+    for (i = traceFirst(&wavegenTrace); i <= last && last != 0; i++)
+        length += traceLine(&wavegenTrace, i, buffer + length, PAGE_SIZE - length);
+
+    return length;
+}
 
-////////////////////////////////////////// Duty Cycles 0 //////////////////////////////////////////
-static int duty0 = 0;
-// module_param(duty0, float, S_IRUGO);
-MODULE_PARM_DESC(duty0, " Duty Cycles of Channel A");
+static struct kobj_attribute traceAttr = __ATTR(trace, 0444, traceShow, NULL);
 
+////////////////////////////////////////// Sample Rate //////////////////////////////////////////
 /**
- *      @brief Kernel object function to set the Duty cycles register on channel A
- *
+ *      @brief Kernel object function to set the sample rate of both channels
  *      @param kobj
  *      @param attr
- *      @param buffer
+ *      @param buffer rate in Hz
  *      @param count
  *      @return ssize_t
  **/
-static ssize_t duty0Store(struct kobject *kobj, struct kobj_attribute *attr, const char *buffer, size_t count)
+static ssize_t rateStore(struct kobject *kobj, struct kobj_attribute *attr, const char *buffer, size_t count)
 {
-    int32_t signedScaled;
-    sscanf(buffer, "%d", &duty0);
+    unsigned int rate;
 
-    signedScaled = (uint32_t)signAndScale(duty0, 100);
+    if (kstrtouint(buffer, 0, &rate) != 0)
+        return -EINVAL;
 
-    printk(KERN_INFO "Set: %d\n", signedScaled);
+    trace(TRACE_INFO, "Set: %d", rate);
 
-    updateDutyCycles(CHANNEL_A, signedScaled);
+    updateSampleRate(rate);
     return count;
 }
 
 /**
- *      @brief Kernel object function to read Duty Cycles register for Channel A
- *
+ *      @brief Kernel object function to read the sample rate
  *      @param kobj
  *      @param attr
  *      @param buffer
  *      @return ssize_t
  **/
-static ssize_t duty0Show(struct kobject *kobj, struct kobj_attribute *attr, char *buffer)
+static ssize_t rateShow(struct kobject *kobj, struct kobj_attribute *attr, char *buffer)
 {
-    sprintf(buffer, "%d", duty0);
+    sprintf(buffer, "%u", getSampleRate());
 
     return strlen(buffer);
 }
 
-static struct kobj_attribute duty0Attr = __ATTR(duty0, 0664, duty0Show, duty0Store);
-
-
-////////////////////////////////////////// Duty Cycles 1 //////////////////////////////////////////
-static int duty1 = 0;
-// module_param(duty1, float, S_IRUGO);
-MODULE_PARM_DESC(duty1, " Duty Cycles of Channel B");
+static struct kobj_attribute rateAttr = __ATTR(rate, 0664, rateShow, rateStore);
 
+////////////////////////////////////////// Trigger //////////////////////////////////////////
 /**
- *      @brief Kernel object function to set the Duty cycles register on channel B
- *
+ *      @brief Kernel object function to start a burst on several channels at once
  *      @param kobj
  *      @param attr
- *      @param buffer
+ *      @param buffer channel mask, bit n = channel n
  *      @param count
  *      @return ssize_t
  **/
-static ssize_t duty1Store(struct kobject *kobj, struct kobj_attribute *attr, const char *buffer, size_t count)
+static ssize_t triggerStore(struct kobject *kobj, struct kobj_attribute *attr, const char *buffer, size_t count)
 {
-    uint32_t signedScaled;
-    sscanf(buffer, "%d", &duty1);
+    unsigned int mask;
 
-    signedScaled = (uint32_t)signAndScale(duty1, 100);
+    if (kstrtouint(buffer, 0, &mask) != 0)
+        return -EINVAL;
 
-    printk(KERN_INFO "Set: %d\n", signedScaled);
-
-    updateDutyCycles(CHANNEL_B, signedScaled);
+    burstTrigger(mask);
     return count;
 }
 
 /**
- *      @brief Kernel object function to read Duty Cycles register for Channel B
- *
+ *      @brief Kernel object function to read the bursts finished on every channel
  *      @param kobj
  *      @param attr
  *      @param buffer
  *      @return ssize_t
  **/
-static ssize_t duty1Show(struct kobject *kobj, struct kobj_attribute *attr, char *buffer)
+static ssize_t triggerShow(struct kobject *kobj, struct kobj_attribute *attr, char *buffer)
 {
-    sprintf(buffer, "%d", duty1);
+    ssize_t length = 0;
+    unsigned int ch;
 
-    return strlen(buffer);
+    for (ch = 0; ch < channels; ch++)
+        length += sprintf(buffer + length, "%u%c", READ_ONCE(burst.completed[ch]), (ch == channels - 1) ? '\n' : ' ');
+
+    return length;
 }
 
-static struct kobj_attribute duty1Attr = __ATTR(duty1, 0664, duty1Show, duty1Store);
+static struct kobj_attribute triggerAttr = __ATTR(trigger, 0664, triggerShow, triggerStore);
 
+static struct kobject *kobj;
 
+/**
+ *      @brief Function to create the sysfs group of every channel
+ *                (Attribute names are built here so /sys/kernel/wavegen/0/mode0
+ *                 and /sys/kernel/wavegen/1/mode1 keep their paths)
+ *      @return int 0 on success, negative error code otherwise
+ **/
+static int createChannels(void)
+{
+    struct wavegen_channel *state;
+    unsigned int i, j;
+    int result;
 
-////////////////////////////////////////// Cycles 0 //////////////////////////////////////////
-static int cycles0 = 0;
-// module_param(cycles0, int, S_IRUGO);
-MODULE_PARM_DESC(cycles0, " Cycles of Channel A");
+    for (i = 0; i < channels; i++)
+    {
+        state = &channelState[i];
+        snprintf(state->groupName, sizeof(state->groupName), "%u", i);
+
+        for (j = 0; j < CHANNEL_ATTRS; j++)
+        {
+            snprintf(state->names[j], sizeof(state->names[j]), "%s%u", channelAttrs[j].name, i);
+
+            sysfs_attr_init(&state->attrs[j].attr);
+            state->attrs[j].attr.name = state->names[j];
+            state->attrs[j].attr.mode = 0664;
+            state->attrs[j].show      = channelAttrs[j].show;
+            state->attrs[j].store     = channelAttrs[j].store;
+            state->attrList[j]        = &state->attrs[j].attr;
+        }
+        state->attrList[CHANNEL_ATTRS] = NULL;
+
+        state->group.name  = state->groupName;
+        state->group.attrs = state->attrList;
+
+        result = sysfs_create_group(kobj, &state->group);
+        if (result != 0)    return result;
+    }
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Character Device
+//-----------------------------------------------------------------------------
 
 /**
- *      @brief Kernel object function to set the Cycles register on channel A
- *
- *      @param kobj
- *      @param attr
- *      @param buffer
- *      @param count
- *      @return ssize_t
+ *      @brief Function to write a complete channel configuration
+ *                (Each register of the channel bank is written once, control
+ *                 register last so the wave is switched over after all of its
+ *                 parameters)
+ *      @param config channel configuration to apply
  **/
-static ssize_t cycles0Store(struct kobject *kobj, struct kobj_attribute *attr, const char *buffer, size_t count)
+static void commitChannel(const struct wavegen_channel_config *config)
 {
-    sscanf(buffer, "%d", &cycles0);
-
-    printk(KERN_INFO "Set: %d\n", cycles0);
+    unsigned int channel = config->channel;
+    uint32_t offset, amplitude, duty, phase, ctrl;
+    unsigned long flags;
+
+    offset    = signAndScale(config->offset, 2500) & 0x0000FFFF;
+    amplitude = signAndScale(config->amplitude, 2500) & 0x0000FFFF;
+    duty      = signAndScale(config->duty, 100) & 0x0000FFFF;
+    phase     = ((config->phase << 16) / 360) & 0x0000FFFF;
+
+    ctrl = config->mode;
+    if (config->hilbert)    ctrl |= CH_CTRL_HILBERT;
+    if (config->complement) ctrl |= CH_CTRL_COMPLEMENT;
+
+    wavegenLock(&wavegen.lock, flags);
+
+    writeShadow(&wavegen, OFS_CH(channel, OFS_CH_FREQ), 0xFFFFFFFF, config->frequency);
+    writeShadow(&wavegen, OFS_CH(channel, OFS_CH_OFFSET), 0xFFFFFFFF, offset);
+    writeShadow(&wavegen, OFS_CH(channel, OFS_CH_AMPLITUDE), 0xFFFFFFFF, amplitude);
+    writeShadow(&wavegen, OFS_CH(channel, OFS_CH_DTYCYC), 0xFFFFFFFF, duty);
+    writeShadow(&wavegen, OFS_CH(channel, OFS_CH_CYCLES), 0xFFFFFFFF, config->cycles & 0x0000FFFF);
+    writeShadow(&wavegen, OFS_CH(channel, OFS_CH_PHASE), 0xFFFFFFFF, phase);
+    writeShadow(&wavegen, OFS_CH(channel, OFS_CH_CTRL), 0xFFFFFFFF, ctrl);
+
+    wavegenUnlock(&wavegen.lock, flags);
+}
 
-    updateCycles(CHANNEL_A, cycles0);
-    return count;
+/**
+ *      @brief Function to mirror a committed configuration into the sysfs values
+ *      @param config channel configuration that was applied
+ **/
+static void storeChannel(const struct wavegen_channel_config *config)
+{
+    struct wavegen_channel *state = &channelState[config->channel];
+
+    state->mode         = config->mode;
+    state->frequency    = config->frequency;
+    state->amplitude    = config->amplitude;
+    state->offset       = config->offset;
+    state->duty         = config->duty;
+    state->cycles       = config->cycles;
+    state->phase        = config->phase;
+    state->hilbert      = config->hilbert;
+    state->comp         = config->complement;
 }
 
 /**
- *      @brief Kernel object function to read Cycles register for Channel A
- *
- *      @param kobj
- *      @param attr
- *      @param buffer
- *      @return ssize_t
+ *      @brief Function to attach an eventfd to an open file, or detach it
+ *      @param state of the open file
+ *      @param fd eventfd to signal once per finished burst, -1 to detach
+ *      @return long 0 on success, negative error code otherwise
  **/
-static ssize_t cycles0Show(struct kobject *kobj, struct kobj_attribute *attr, char *buffer)
+static long wavegenSetEventfd(struct wavegen_file *state, int fd)
 {
-    sprintf(buffer, "%d", cycles0);
+    struct eventfd_ctx *eventfd = NULL, *previous;
+    unsigned long flags;
 
-    return strlen(buffer);
+    if (fd >= 0)
+    {
+        eventfd = eventfd_ctx_fdget(fd);
+        if (IS_ERR(eventfd))
+            return PTR_ERR(eventfd);
+    }
+
+    spin_lock_irqsave(&burst.lock, flags);
+    previous = state->eventfd;
+    if (previous != NULL)
+        list_del(&state->node);
+
+    state->eventfd = eventfd;
+    if (eventfd != NULL)
+        list_add(&state->node, &burst.files);
+    spin_unlock_irqrestore(&burst.lock, flags);
+
+    if (previous != NULL)
+        eventfd_ctx_put(previous);
+    return 0;
 }
 
-static struct kobj_attribute cycles0Attr = __ATTR(cycles0, 0664, cycles0Show, cycles0Store);
+/**
+ *      @brief Character device open handler
+ *                (Bursts finished before the open are not reported)
+ *      @param inode
+ *      @param file
+ *      @return int 0 on success, negative error code otherwise
+ **/
+static int wavegenOpen(struct inode *inode, struct file *file)
+{
+    struct wavegen_file *state = kzalloc(sizeof(*state), GFP_KERNEL);
+    unsigned long flags;
+
+    if (state == NULL)
+        return -ENOMEM;
 
+    spin_lock_irqsave(&burst.lock, flags);
+    memcpy(state->seen, burst.completed, sizeof(state->seen));
+    spin_unlock_irqrestore(&burst.lock, flags);
 
-////////////////////////////////////////// Cycles 1 //////////////////////////////////////////
-static int cycles1 = 0;
-// module_param(cycles1, int, S_IRUGO);
-MODULE_PARM_DESC(cycles1, " Cycles of Channel B");
+    file->private_data = state;
+    return 0;
+}
 
 /**
- *      @brief Kernel object function to set the Cycles register on channel B
- *
- *      @param kobj
- *      @param attr
- *      @param buffer
- *      @param count
- *      @return ssize_t
+ *      @brief Character device release handler
+ *      @param inode
+ *      @param file
+ *      @return int 0
+ **/
+static int wavegenRelease(struct inode *inode, struct file *file)
+{
+    wavegenSetEventfd(file->private_data, -1);
+    kfree(file->private_data);
+    return 0;
+}
+
+/**
+ *      @brief Character device read handler, reports finished bursts
+ *                (Blocks until a channel finished a burst since the last
+ *                 read on this file, unless opened O_NONBLOCK)
+ *      @param file
+ *      @param buffer user space struct wavegen_burst_status
+ *      @param count bytes to read, at least sizeof(struct wavegen_burst_status)
+ *      @param position unused
+ *      @return ssize_t bytes read, negative error code otherwise
  **/
-static ssize_t cycles1Store(struct kobject *kobj, struct kobj_attribute *attr, const char *buffer, size_t count)
+static ssize_t wavegenRead(struct file *file, char __user *buffer, size_t count, loff_t *position)
 {
-    sscanf(buffer, "%d", &cycles1);
+    struct wavegen_file *state = file->private_data;
+    struct wavegen_burst_status status = {0};
+    unsigned long flags;
+    unsigned int ch;
+    int result;
 
-    printk(KERN_INFO "Set: %d\n", cycles1);
+    if (count < sizeof(status))
+        return -EINVAL;
 
-    updateCycles(CHANNEL_B, cycles1);
-    return count;
+    if (file->f_flags & O_NONBLOCK)
+    {
+        if (!burstPending(state))
+            return -EAGAIN;
+    }
+    else
+    {
+        result = wait_event_interruptible(burst.wait, burstPending(state));
+        if (result != 0)
+            return result;
+    }
+
+    spin_lock_irqsave(&burst.lock, flags);
+    for (ch = 0; ch < channels; ch++)
+    {
+        if (burst.completed[ch] != state->seen[ch])
+        {
+            status.done   |= 1u << ch;
+            status.bursts += burst.completed[ch] - state->seen[ch];
+            state->seen[ch] = burst.completed[ch];
+        }
+    }
+    spin_unlock_irqrestore(&burst.lock, flags);
+
+    if (copy_to_user(buffer, &status, sizeof(status)))
+        return -EFAULT;
+    return sizeof(status);
 }
 
 /**
- *      @brief Kernel object function to read Cycles register for Channel B
- *
- *      @param kobj
- *      @param attr
- *      @param buffer
- *      @return ssize_t
+ *      @brief Character device poll handler
+ *                (Readable while a finished burst has not been read)
+ *      @param file
+ *      @param wait poll table
+ *      @return __poll_t POLLIN when read() would not block
  **/
-static ssize_t cycles1Show(struct kobject *kobj, struct kobj_attribute *attr, char *buffer)
+static __poll_t wavegenPoll(struct file *file, poll_table *wait)
 {
-    sprintf(buffer, "%d", cycles1);
+    poll_wait(file, &burst.wait, wait);
 
-    return strlen(buffer);
+    return burstPending(file->private_data) ? (POLLIN | POLLRDNORM) : 0;
 }
 
-static struct kobj_attribute cycles1Attr = __ATTR(cycles1, 0664, cycles1Show, cycles1Store);
+/**
+ *      @brief Character device ioctl handler
+ *      @param file
+ *      @param cmd ioctl command
+ *      @param arg user space pointer to the command argument
+ *      @return long 0 on success, negative error code otherwise
+ **/
+static long wavegenIoctl(struct file *file, unsigned int cmd, unsigned long arg)
+{
+    struct wavegen_channel_config config;
+    __u32 mask;
+    __s32 fd;
+
+    switch (cmd)
+    {
+        case WAVEGEN_IOC_SET_CHANNEL:
+            if (copy_from_user(&config, (void __user *)arg, sizeof(config)))
+                return -EFAULT;
+
+            // Same ranges as the sysfs files, the scaled values would wrap
+            if (config.channel >= channels || config.mode > MODE_STREAM || config.phase > 360)
+                return -EINVAL;
+            if (config.amplitude < -2500 || config.amplitude > 2500 ||
+                config.offset < -2500 || config.offset > 2500 ||
+                config.duty > 100 || config.cycles > 0xFFFF)
+                return -EINVAL;
+
+            commitChannel(&config);
+            storeChannel(&config);
+            return 0;
+
+        case WAVEGEN_IOC_TRIGGER:
+            if (copy_from_user(&mask, (void __user *)arg, sizeof(mask)))
+                return -EFAULT;
+
+            burstTrigger(mask);
+            return 0;
 
+        case WAVEGEN_IOC_SET_EXT_TRIGGER:
+            if (copy_from_user(&mask, (void __user *)arg, sizeof(mask)))
+                return -EFAULT;
 
-////////////////////////////////////////// Phase 0 //////////////////////////////////////////
-static int phase0 = 0;
-MODULE_PARM_DESC(phase0, " Phase of Channel A");
+            burstSetExternal(0xFFFFFFFF, mask);
+            return 0;
+
+        case WAVEGEN_IOC_SET_EVENTFD:
+            if (copy_from_user(&fd, (void __user *)arg, sizeof(fd)))
+                return -EFAULT;
+
+            return wavegenSetEventfd(file->private_data, fd);
+
+        default:
+            return -ENOTTY;
+    }
+}
 
 /**
- *      @brief Function to set the phase value for Channel A
- *      @param kobj
- *      @param attr
- *      @param buffer
- *      @param count
- *      @return ssize_t
+ *      @brief Character device write handler, uploads arbitrary waveform samples
+ *                (The file position counts bytes of int16_t samples, channel 0
+ *                 table first then channel 1 and so on, so one write can load
+ *                 several)
+ *      @param file
+ *      @param buffer user space int16_t samples, signed Q14
+ *      @param count bytes to write
+ *      @param position byte position in the tables
+ *      @return ssize_t bytes written, negative error code otherwise
  **/
-static ssize_t phase0Store(struct kobject *kobj, struct kobj_attribute *attr, const char *buffer, size_t count)
+static ssize_t wavegenWrite(struct file *file, const char __user *buffer, size_t count, loff_t *position)
 {
-    uint32_t signedScaled;
+    const size_t tableBytes = channels * ARB_SAMPLES * sizeof(int16_t);
+    int16_t samples[64];
+    size_t done = 0, chunk, i;
+    unsigned int index;
 
-    sscanf(buffer, "%d", &phase0);
+    if (*position < 0 || (*position & 1) || (count & 1))
+        return -EINVAL;
+    if (*position >= tableBytes)
+        return -ENOSPC;
 
-    signedScaled = (phase0 << 12) / 360;
+    count = min(count, (size_t)(tableBytes - *position));
 
-    printk(KERN_INFO "Set: %d\n", phase0);
+    while (done < count)
+    {
+        chunk = min(count - done, sizeof(samples));
+        if (copy_from_user(samples, buffer + done, chunk))
+            return done ? done : -EFAULT;
 
-    // signedScaled = (uint16_t)signAndScale(phase0, 360) & 0xFFFF;
+        // Tables follow each other, one sample per 32 bit word
+        index = (*position + done) / sizeof(int16_t);
+        for (i = 0; i < chunk / sizeof(int16_t); i++)
+            wavegen.bus->write(wavegen.base, OFS_ARB(0) + index + i, (uint16_t)samples[i]);
 
-    updatePhase(CHANNEL_A, signedScaled);
+        done += chunk;
+    }
 
-    return count;
+    *position += done;
+    return done;
 }
 
 /**
- *      @brief Function to read the phase value from register for Channel A
- *      @param kobj
- *      @param attr
- *      @param buffer
- *      @return ssize_t
+ *      @brief Character device mmap handler, maps the arbitrary waveform tables
+ *                (Page n is the table of channel n, one uint32_t per sample
+ *                 with the signed Q14 sample in bits 15:0)
+ *      @param file
+ *      @param vma user mapping to fill
+ *      @return int 0 on success, negative error code otherwise
  **/
-static ssize_t phase0Show(struct kobject *kobj, struct kobj_attribute *attr, char *buffer)
+static int wavegenMmap(struct file *file, struct vm_area_struct *vma)
 {
-    sprintf(buffer, "%d", phase0);
+    unsigned long size = vma->vm_end - vma->vm_start;
 
-    return strlen(buffer);
+    if (vma->vm_pgoff + (size >> PAGE_SHIFT) > ((channels * ARB_TABLE_IN_BYTES) >> PAGE_SHIFT))
+        return -EINVAL;
+
+    if (mock)
+        return remap_vmalloc_range(vma, wavegen.base, vma->vm_pgoff + (ARB_OFFSET_IN_BYTES >> PAGE_SHIFT));
+
+    vma->vm_page_prot = pgprot_noncached(vma->vm_page_prot);
+    return io_remap_pfn_range(vma, vma->vm_start,
+                              ((AXI4_LITE_BASE + WAVEGEN_IP_OFFSET + ARB_OFFSET_IN_BYTES) >> PAGE_SHIFT) + vma->vm_pgoff,
+                              size, vma->vm_page_prot);
 }
 
-static struct kobj_attribute phase0Attr = __ATTR(phase0, 0664, phase0Show, phase0Store);
+static const struct file_operations wavegenFops =
+    {
+        .owner          = THIS_MODULE,
+        .open           = wavegenOpen,
+        .release        = wavegenRelease,
+        .unlocked_ioctl = wavegenIoctl,
+        .read           = wavegenRead,
+        .write          = wavegenWrite,
+        .poll           = wavegenPoll,
+        .mmap           = wavegenMmap,
+        .llseek         = default_llseek,
+    };
+
+static struct miscdevice wavegenMisc =
+    {
+        .minor  = MISC_DYNAMIC_MINOR,
+        .name   = WAVEGEN_DEVICE_NAME,
+        .fops   = &wavegenFops,
+        .mode   = 0666
+    };
 
+//-----------------------------------------------------------------------------
+// Stream Device
+//-----------------------------------------------------------------------------
 
-////////////////////////////////////////// Phase 1 //////////////////////////////////////////
-static int phase1 = 0;
-MODULE_PARM_DESC(phase1, " Phase of Channel B");
+// Coherent DMA ring played in order by the AXI DMA MM2S channel into the
+// sample FIFO of the IP (mode 6). User space fills the ring through mmap and
+// publishes it by advancing control->producer, the driver advances
+// control->consumer as transfers complete, so steady streaming needs no
+// syscalls; poll() waits for room and restarts a ring that ran dry.
+struct wavegen_stream
+{
+    struct dma_chan *chan;                  // AXI DMA MM2S channel
+    struct device *dev;                     // Device the ring is allocated for
+    void *ring;                             // WAVEGEN_STREAM_RING_BYTES, then the control page
+    dma_addr_t ringDma;
+    struct wavegen_stream_control *control; // Shared index pair
+    uint32_t submitted;                     // Bytes handed to the DMA, free running
+    uint32_t consumed;                      // Bytes played, published as control->consumer
+    uint32_t inflight[WAVEGEN_STREAM_BUFFERS]; // Length of each transfer in flight, oldest first
+    unsigned int head, count;               // Oldest transfer and transfers in flight
+    bool broken;                            // Producer index out of range, nothing is submitted
+    atomic_t users;                         // Open files, at most one
+    wait_queue_head_t wait;                 // Woken for every completed transfer
+    spinlock_t lock;                        // Serializes submission and completion
+};
+
+static struct wavegen_stream stream;
+
+static void streamDone(void *param);
 
 /**
- *      @brief Function to set the phase value for Channel B
- *      @param kobj
- *      @param attr
- *      @param buffer
- *      @param count
- *      @return ssize_t
+ *      @brief Function to read the producer index published by user space
+ *                (It may not fall behind what was submitted nor run more than
+ *                 the ring ahead of what was played; the stream stops for
+ *                 good, until the device is reopened, when it does)
+ *      @param producer index read
+ *      @return bool true when the index is valid
  **/
-static ssize_t phase1Store(struct kobject *kobj, struct kobj_attribute *attr, const char *buffer, size_t count)
+static bool streamProducer(uint32_t *producer)
 {
-    uint32_t signedScaled;
+    *producer = smp_load_acquire(&stream.control->producer);
 
-    sscanf(buffer, "%d", &phase1);
+    if (!stream.broken &&
+        (*producer - stream.consumed) <= WAVEGEN_STREAM_RING_BYTES &&
+        (*producer - stream.submitted) <= (*producer - stream.consumed))
+        return true;
 
-    signedScaled = (phase1 << 12) / 360;
+    if (!stream.broken)
+        trace(TRACE_ERROR, "producer %u, consumed %u", *producer, stream.consumed);
+    stream.broken = true;
+    return false;
+}
 
-    printk(KERN_INFO "Set: %d\n", phase1);
+/**
+ *      @brief Function to hand everything published by the producer to the DMA
+ *                (Caller holds stream.lock, transfers never wrap the ring end)
+ **/
+static void streamKick(void)
+{
+    struct dma_async_tx_descriptor *descriptor;
+    uint32_t producer, position, bytes;
 
-    // signedScaled = (uint16_t)signAndScale(phase1, 360) & 0xFFFF;
+    if (!streamProducer(&producer))
+        return;
 
-    updatePhase(CHANNEL_B, signedScaled);
-    return count;
+    while (stream.count < WAVEGEN_STREAM_BUFFERS && (producer - stream.submitted) >= 4)
+    {
+        position = stream.submitted % WAVEGEN_STREAM_RING_BYTES;
+        bytes    = min(producer - stream.submitted, (uint32_t)WAVEGEN_STREAM_BUFFER_BYTES);
+        bytes    = min(bytes, (uint32_t)(WAVEGEN_STREAM_RING_BYTES - position)) & ~3u;
+
+        descriptor = dmaengine_prep_slave_single(stream.chan, stream.ringDma + position, bytes,
+                                                 DMA_MEM_TO_DEV, DMA_PREP_INTERRUPT | DMA_CTRL_ACK);
+        if (descriptor == NULL)
+            break;
+
+        descriptor->callback       = streamDone;
+        descriptor->callback_param = NULL;
+        if (dma_submit_error(dmaengine_submit(descriptor)))
+            break;
+
+        stream.inflight[(stream.head + stream.count) % WAVEGEN_STREAM_BUFFERS] = bytes;
+        stream.count++;
+        stream.submitted += bytes;
+        trace(TRACE_DEBUG, "position %d, bytes %d", position, bytes);
+    }
+
+    dma_async_issue_pending(stream.chan);
 }
 
 /**
- *      @brief Function to read the phase value from register for Channel B
- *      @param kobj
- *      @param attr
- *      @param buffer
- *      @return ssize_t
+ *      @brief DMA completion callback, one call per transfer in queue order
+ *      @param param unused
  **/
-static ssize_t phase1Show(struct kobject *kobj, struct kobj_attribute *attr, char *buffer)
+static void streamDone(void *param)
 {
-    sprintf(buffer, "%d", phase1);
+    unsigned long flags;
 
-    return strlen(buffer);
+    spin_lock_irqsave(&stream.lock, flags);
+
+    stream.consumed += stream.inflight[stream.head];
+    smp_store_release(&stream.control->consumer, stream.consumed);
+    stream.head = (stream.head + 1) % WAVEGEN_STREAM_BUFFERS;
+    stream.count--;
+
+    streamKick();
+    if (stream.count == 0 && !stream.broken)
+        WRITE_ONCE(stream.control->underruns, stream.control->underruns + 1);
+
+    spin_unlock_irqrestore(&stream.lock, flags);
+    wake_up_interruptible(&stream.wait);
 }
 
-static struct kobj_attribute phase1Attr = __ATTR(phase1, 0664, phase1Show, phase1Store);
+/**
+ *      @brief Stream device poll handler
+ *                (Writable while at least one transfer worth of the ring is free)
+ *      @param file
+ *      @param wait poll table
+ *      @return __poll_t POLLOUT when there is room, POLLERR after a bad producer index
+ **/
+static __poll_t streamPoll(struct file *file, poll_table *wait)
+{
+    unsigned long flags;
+    uint32_t producer;
+    bool valid;
 
+    poll_wait(file, &stream.wait, wait);
 
+    spin_lock_irqsave(&stream.lock, flags);
+    streamKick();
+    valid = streamProducer(&producer);
+    spin_unlock_irqrestore(&stream.lock, flags);
 
+    if (!valid)
+        return POLLERR;
+    return (WAVEGEN_STREAM_RING_BYTES - (producer - stream.consumed) >= WAVEGEN_STREAM_BUFFER_BYTES) ? (POLLOUT | POLLWRNORM) : 0;
+}
 
+/**
+ *      @brief Stream device mmap handler, maps the ring and the control page
+ *      @param file
+ *      @param vma user mapping to fill
+ *      @return int 0 on success, negative error code otherwise
+ **/
+static int streamMmap(struct file *file, struct vm_area_struct *vma)
+{
+    if (vma->vm_pgoff != 0 || vma->vm_end - vma->vm_start > WAVEGEN_STREAM_MAP_BYTES)
+        return -EINVAL;
+
+    return dma_mmap_coherent(stream.dev, vma, stream.ring, stream.ringDma, vma->vm_end - vma->vm_start);
+}
 
+/**
+ *      @brief Stream device open handler, the ring has a single producer
+ *      @param inode
+ *      @param file
+ *      @return int 0 on success, -EBUSY while another file is open
+ **/
+static int streamOpen(struct inode *inode, struct file *file)
+{
+    return (atomic_cmpxchg(&stream.users, 0, 1) == 0) ? 0 : -EBUSY;
+}
 
-// Attributes
-static struct attribute *attrs0[] =
+/**
+ *      @brief Stream device release handler, stops the DMA and empties the ring
+ *      @param inode
+ *      @param file
+ *      @return int 0
+ **/
+static int streamRelease(struct inode *inode, struct file *file)
+{
+    unsigned long flags;
+
+    dmaengine_terminate_sync(stream.chan);
+
+    spin_lock_irqsave(&stream.lock, flags);
+    memset(stream.control, 0, sizeof(*stream.control));
+    stream.submitted = 0;
+    stream.consumed  = 0;
+    stream.head      = 0;
+    stream.count     = 0;
+    stream.broken    = false;
+    spin_unlock_irqrestore(&stream.lock, flags);
+
+    atomic_set(&stream.users, 0);
+    return 0;
+}
+
+static const struct file_operations streamFops =
     {
-        &mode0Attr.attr,
-        &run0Attr.attr,
-        &amplitude0Attr.attr,
-        &offset0Attr.attr,
-        &duty0Attr.attr,
-        &cycles0Attr.attr,
-        &frequency0Attr.attr,
-        &phase0Attr.attr,
-        &comp0Attr.attr,
-        &hilbert0Attr.attr,
-        NULL
+        .owner          = THIS_MODULE,
+        .open           = streamOpen,
+        .poll           = streamPoll,
+        .mmap           = streamMmap,
+        .release        = streamRelease,
     };
-static struct attribute *attrs1[] =
+
+static struct miscdevice streamMisc =
     {
-        &mode1Attr.attr,
-        &run1Attr.attr,
-        &amplitude1Attr.attr,
-        &offset1Attr.attr,
-        &duty1Attr.attr,
-        &cycles1Attr.attr,
-        &frequency1Attr.attr,
-        &phase1Attr.attr,
-        &comp1Attr.attr,
-        &hilbert1Attr.attr,
-        NULL
+        .minor  = MISC_DYNAMIC_MINOR,
+        .name   = WAVEGEN_STREAM_NAME,
+        .fops   = &streamFops,
+        .mode   = 0666
     };
 
-static struct attribute_group group0 =
+/**
+ *      @brief Function to claim the AXI DMA channel, allocate the ring
+ *                and create /dev/wavegen_stream
+ *                (The channel is the "tx" entry of dmas/dma-names in the
+ *                 device tree node of the IP, the MM2S channel feeding
+ *                 SAMP_AXIS; streaming stays disabled without it)
+ **/
+static void streamInit(void)
+{
+    if (node == NULL)
     {
-        .name = "0",
-        .attrs = attrs0
-    };
+        printk(KERN_INFO "Wavegen driver: no device tree node, streaming disabled\n");
+        return;
+    }
 
-static struct attribute_group group1 =
+    stream.chan = of_dma_request_slave_channel(node, "tx");
+    if (IS_ERR_OR_NULL(stream.chan))
     {
-        .name = "1",
-        .attrs = attrs1
-    };
+        stream.chan = NULL;
+        printk(KERN_INFO "Wavegen driver: no DMA channel, streaming disabled\n");
+        return;
+    }
 
-static struct kobject *kobj;
+    stream.dev     = stream.chan->device->dev;
+    stream.ring    = dma_alloc_coherent(stream.dev, WAVEGEN_STREAM_MAP_BYTES, &stream.ringDma, GFP_KERNEL);
+    stream.control = (struct wavegen_stream_control *)((uint8_t *)stream.ring + WAVEGEN_STREAM_RING_BYTES);
+    init_waitqueue_head(&stream.wait);
+    spin_lock_init(&stream.lock);
+
+    if (stream.ring == NULL || misc_register(&streamMisc) != 0)
+    {
+        if (stream.ring != NULL)
+            dma_free_coherent(stream.dev, WAVEGEN_STREAM_MAP_BYTES, stream.ring, stream.ringDma);
+        dma_release_channel(stream.chan);
+        stream.chan = NULL;
+        printk(KERN_ALERT "Wavegen driver: failed to set up streaming\n");
+    }
+}
+
+static void streamExit(void)
+{
+    if (stream.chan == NULL)
+        return;
+
+    misc_deregister(&streamMisc);
+    dmaengine_terminate_sync(stream.chan);
+    dma_free_coherent(stream.dev, WAVEGEN_STREAM_MAP_BYTES, stream.ring, stream.ringDma);
+    dma_release_channel(stream.chan);
+}
 
 //-----------------------------------------------------------------------------
 // Initialization and Exit
@@ -1442,26 +1757,113 @@ static int __init initialize_module(void)
         return -ENOENT;
     }
 
-    // Create wavegen0 and wavegen1 groups
-    result = sysfs_create_group(kobj, &group0);
-    if (result != 0)    return result;
+    // Trace ring under /sys/kernel/wavegen/trace
+    result = sysfs_create_file(kobj, &traceAttr.attr);
+    if (result != 0)    goto failKobject;
+
+    // Sample rate under /sys/kernel/wavegen/rate
+    result = sysfs_create_file(kobj, &rateAttr.attr);
+    if (result != 0)    goto failKobject;
+
+    // Burst trigger under /sys/kernel/wavegen/trigger
+    result = sysfs_create_file(kobj, &triggerAttr.attr);
+    if (result != 0)    goto failKobject;
+
+    if (mock)
+    {
+        // In-memory pages standing in for the IP registers and sample tables
+        wavegen.bus  = &wavegenMemoryBus;
+        wavegen.base = (uint32_t *)vmalloc_user(IP_SPAN_IN_BYTES);
+        printk(KERN_INFO "Wavegen driver: using mock registers\n");
+    }
+    else
+    {
+        // Physical to virtual memory map to access gpio registers
+        wavegen.bus  = &wavegenMmioBus;
+        wavegen.base = (uint32_t *)ioremap(AXI4_LITE_BASE + WAVEGEN_IP_OFFSET, IP_SPAN_IN_BYTES);
+    }
+
+    if (wavegen.base == NULL)
+    {
+        result = -ENODEV;
+        goto failKobject;
+    }
+
+    loadShadow(&wavegen);
+
+    // Channel count from the IP, IPs without the register read 0
+    if (channels == 0)  channels = readRegister(&wavegen, OFS_CHANNELS);
+    if (channels == 0)  channels = WAVEGEN_DEFAULT_CHANNELS;
+    channels = min(channels, (unsigned int)WAVEGEN_MAX_CHANNELS);
+
+    if (mock)
+        writeShadow(&wavegen, OFS_CHANNELS, 0xFFFFFFFF, channels);
+
+    // Create one group per channel, /sys/kernel/wavegen/[channel]
+    result = createChannels();
+    if (result != 0)    goto failMap;
+
+    printk(KERN_INFO "Wavegen driver: %u channels\n", channels);
 
-    result = sysfs_create_group(kobj, &group1);
-    if (result != 0)    return result;
+    // Burst done interrupt, or a poll of the done register
+    INIT_LIST_HEAD(&burst.files);
+    init_waitqueue_head(&burst.wait);
+    spin_lock_init(&burst.lock);
+    INIT_DELAYED_WORK(&burst.poll, burstPoll);
 
-    // Physical to virtual memory map to access gpio registers
-    base = (unsigned int *)ioremap(AXI4_LITE_BASE + WAVEGEN_IP_OFFSET, SPAN_IN_BYTES);
+    if (!mock)
+        node = of_find_compatible_node(NULL, NULL, WAVEGEN_COMPATIBLE);
+    if (node != NULL)
+        irq = irq_of_parse_and_map(node, 0);
 
-    if (base == NULL)   return -ENODEV;
+    if (irq > 0)
+    {
+        result = request_irq(irq, burstIrq, 0, WAVEGEN_DEVICE_NAME, &burst);
+        if (result != 0)    goto failNode;
+    }
+
+    // Create /dev/wavegen for whole channel updates
+    result = misc_register(&wavegenMisc);
+    if (result != 0)    goto failIrq;
+
+    // Create /dev/wavegen_stream when an AXI DMA channel is present
+    if (!mock)
+        streamInit();
 
     printk(KERN_INFO "Wavegen driver: initialized\n");
 
     return 0;
+
+    // Undo the steps above in reverse order, kobject_put removes every
+    // sysfs file and channel group below /sys/kernel/wavegen
+failIrq:
+    if (irq > 0)
+        free_irq(irq, &burst);
+failNode:
+    of_node_put(node);
+failMap:
+    if (mock)   vfree(wavegen.base);
+    else        iounmap(wavegen.base);
+failKobject:
+    kobject_put(kobj);
+    printk(KERN_ALERT "Wavegen driver: initialization failed (%d)\n", result);
+    return result;
 }
 
 static void __exit exit_module(void)
 {
+    // Remove every way in first: sysfs writes and ioctls queue burst.poll
+    streamExit();
+    misc_deregister(&wavegenMisc);
     kobject_put(kobj);
+
+    if (irq > 0)
+        free_irq(irq, &burst);
+    cancel_delayed_work_sync(&burst.poll);
+    of_node_put(node);
+
+    if (mock)   vfree(wavegen.base);
+    else        iounmap(wavegen.base);
     printk(KERN_INFO "Wavegen driver: exit\n");
 }
 
@@ -0,0 +1,70 @@
+// WAVEGEN character device interface
+// Shared between the kernel driver and user space
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#ifndef WAVEGEN_IOCTL_H
+#define WAVEGEN_IOCTL_H
+
+#include <linux/types.h>
+#include <linux/ioctl.h>
+
+#define WAVEGEN_DEVICE_NAME "wavegen"
+#define WAVEGEN_STREAM_NAME "wavegen_stream"
+
+// Coherent DMA ring behind /dev/wavegen_stream, mmap to fill it in place
+// Each 32 bit word is one sample pair: DAC A word in bits 11:0, DAC B word in bits 27:16
+#define WAVEGEN_STREAM_BUFFERS      8                   // DMA transfers in flight at most
+#define WAVEGEN_STREAM_BUFFER_BYTES (64 * 1024)         // Largest DMA transfer
+#define WAVEGEN_STREAM_RING_BYTES   (WAVEGEN_STREAM_BUFFERS * WAVEGEN_STREAM_BUFFER_BYTES)
+#define WAVEGEN_STREAM_MAP_BYTES    (WAVEGEN_STREAM_RING_BYTES + 4096) // Ring, then the control page
+
+// Index pair in the control page after the ring, both count bytes and run freely
+// (ring offset = index % WAVEGEN_STREAM_RING_BYTES)
+struct wavegen_stream_control
+{
+    __u32 producer;     // Bytes written into the ring, advanced by user space after the samples
+    __u32 consumer;     // Bytes played by the DMA, advanced by the driver
+    __u32 underruns;    // Times the DMA ran out of samples, advanced by the driver
+};
+
+// Complete configuration of one channel, in the same units as the sysfs files
+struct wavegen_channel_config
+{
+    __u32 channel;      // 0 to channel count - 1 (0 = channel A, 1 = channel B)
+    __u32 mode;         // 0 = dc, 1 = sine, 2 = saw, 3 = tri, 4 = sq, 5 = arb, 6 = stream
+    __u32 frequency;    // Hz
+    __s32 amplitude;    // mV, -2500 to 2500
+    __s32 offset;       // mV, -2500 to 2500
+    __u32 duty;         // percent, 0 to 100
+    __u32 cycles;       // 0 = continuous, n = n cycles, up to 65535
+    __u32 phase;        // degrees, 0 to 360
+    __u32 hilbert;      // 0 = off, 1 = on
+    __u32 complement;   // 0 = independent, 1 = complement the other channel
+};
+
+#define WAVEGEN_IOC_MAGIC 'w'
+
+// Write every register affected by a channel configuration in one call
+#define WAVEGEN_IOC_SET_CHANNEL _IOW(WAVEGEN_IOC_MAGIC, 1, struct wavegen_channel_config)
+
+// Start a burst of cycles periods on every channel in the mask (bit n = channel n)
+#define WAVEGEN_IOC_TRIGGER _IOW(WAVEGEN_IOC_MAGIC, 2, __u32)
+
+// Channels started by the external trigger input (bit n = channel n)
+#define WAVEGEN_IOC_SET_EXT_TRIGGER _IOW(WAVEGEN_IOC_MAGIC, 3, __u32)
+
+// eventfd signalled once per finished burst on any channel, -1 to detach
+#define WAVEGEN_IOC_SET_EVENTFD _IOW(WAVEGEN_IOC_MAGIC, 4, __s32)
+
+// Read from /dev/wavegen: bursts finished since the last read on the same
+// file descriptor, blocks until there is one (poll() reports POLLIN)
+struct wavegen_burst_status
+{
+    __u32 done;         // Bit n = channel n finished a burst
+    __u32 bursts;       // Bursts finished on those channels
+};
+
+#endif
@@ -15,16 +15,17 @@
 
 #include <stdint.h>         // C99 integer types -- uint32_t
 #include <stdbool.h>        // bool
+#include <stdlib.h>         // getenv
 #include <fcntl.h>          // open
 #include <sys/mman.h>       // mmap
-#include <unistd.h>         // close
+#include <unistd.h>         // close, ftruncate
 #include "../address_map.h" // address map
 // #include "address_map.h"  // address map
 #include "wavegen_ip.h"     // wavegen functions
 #include "wavegenIp_regs.h" // wavegen registers
+#include "wavegen_trace.h"  // trace
 
 #include <stdio.h>
-#define printd(format, ...) printf("[DEBUG][%d][%s][%s] " format "\n", __LINE__, __FILE__, __func__, ##__VA_ARGS__) // Debug print
 
 //-----------------------------------------------------------------------------
 // Global variables
@@ -33,15 +34,29 @@
 #define CHANNEL_A_MODE_MASK 0x07 // 0b00000111
 #define CHANNEL_B_MODE_MASK 0x38 // 0b00111000
 #define FREQ_MASK 0xFFFFFFFF     // 32-bit mask
+#define REGISTER_COUNT (SPAN_IN_BYTES / 4)
 
 uint32_t *base = NULL;
 
+// Register values staged between waveGenBegin() and waveGenCommit()
+static bool batching = false;
+static uint32_t staged[REGISTER_COUNT];
+static uint32_t loaded = 0;         // Registers read into staged[], one bit each
+static uint32_t dirty = 0;          // Registers modified in staged[], one bit each
+
+struct wavegen_trace wavegenTrace;
+
 //-----------------------------------------------------------------------------
 // Subroutines
 //-----------------------------------------------------------------------------
 
 bool waveGenOpen()
 {
+    // Use an in-memory register file instead of the IP when requested
+    const char *mock = getenv("WAVEGEN_MOCK");
+    if (mock != NULL)
+        return waveGenOpenFile(mock);
+
     // Open /dev/mem
     int file = open("/dev/mem", O_RDWR | O_SYNC);
     bool bOK = (file >= 0);
@@ -49,22 +64,96 @@ bool waveGenOpen()
     {
         // Create a map from the physical memory location of
         // /dev/mem at an offset to LW avalon interface
-        // with an aperture of SPAN_IN_BYTES bytes
+        // with an aperture of IP_SPAN_IN_BYTES bytes (registers and sample tables)
         // to any location in the virtual 32-bit memory space of the process
-        base = mmap(NULL, SPAN_IN_BYTES, PROT_READ | PROT_WRITE, MAP_SHARED,
+        base = mmap(NULL, IP_SPAN_IN_BYTES, PROT_READ | PROT_WRITE, MAP_SHARED,
                     file, AXI4_LITE_BASE + WAVEGEN_IP_OFFSET);
         bOK = (base != MAP_FAILED);
 
         // Close /dev/mem
         close(file);
     }
-    printd();
+    trace(TRACE_INFO, "ok %d", bOK);
+    return bOK;
+}
+
+bool waveGenOpenFile(const char *path)
+{
+    // Open or create the file standing in for the IP registers
+    // (e.g. /dev/shm/wavegen so several processes share the same registers)
+    int file = open(path, O_RDWR | O_CREAT, 0666);
+    bool bOK = (file >= 0) && (ftruncate(file, IP_SPAN_IN_BYTES) == 0);
+    if (bOK)
+    {
+        // Map the file with the same register and sample table layout as the IP
+        base = mmap(NULL, IP_SPAN_IN_BYTES, PROT_READ | PROT_WRITE, MAP_SHARED,
+                    file, 0);
+        bOK = (base != MAP_FAILED);
+    }
+    if (file >= 0)
+        close(file);
+    trace(TRACE_INFO, "ok %d", bOK);
     return bOK;
 }
 
+// Read a register, from the staged copy while batching
+static uint32_t readReg(uint32_t offset)
+{
+    if (!batching)
+        return *(base + offset);
+
+    if (!(loaded & (1 << offset)))
+    {
+        staged[offset] = *(base + offset); // Each register is read at most once per batch
+        loaded |= 1 << offset;
+    }
+    return staged[offset];
+}
+
+// Write a register, or stage it until waveGenCommit() while batching
+static void writeReg(uint32_t offset, uint32_t value)
+{
+    if (!batching)
+    {
+        *(base + offset) = value;
+        return;
+    }
+
+    staged[offset] = value;
+    loaded |= 1 << offset;
+    dirty |= 1 << offset;
+}
+
+void waveGenBegin()
+{
+    batching = true;
+    loaded = 0;
+    dirty = 0;
+}
+
+void waveGenCommit()
+{
+    uint32_t i;
+
+    // One write per modified register, run register last so the waves
+    // start or stop only once every other parameter is in place
+    for (i = 0; i < REGISTER_COUNT; i++)
+    {
+        if (i != OFS_RUN && (dirty & (1 << i)))
+            *(base + i) = staged[i];
+    }
+    if (dirty & (1 << OFS_RUN))
+        *(base + OFS_RUN) = staged[OFS_RUN];
+
+    trace(TRACE_DEBUG, "dirty %x", dirty);
+    batching = false;
+    loaded = 0;
+    dirty = 0;
+}
+
 void setChannelMode(volatile uint32_t channel, volatile uint32_t mode)
 {
-    uint32_t regValue = *(base + OFS_MODE); // Read the current register value
+    uint32_t regValue = readReg(OFS_MODE); // Read the current register value
 
     if (channel == 0)
     { // READ... Clear the mode bits for the specified channel
@@ -84,21 +173,21 @@ void setChannelMode(volatile uint32_t channel, volatile uint32_t mode)
         regValue |= ((mode << 3) & CHANNEL_B_MODE_MASK);
     }
 
-    *(base + OFS_MODE) = regValue; // WRITE the modified value back to the register
-    printd("ch %d, mode %d", channel, mode);
+    writeReg(OFS_MODE, regValue); // WRITE the modified value back to the register
+    trace(TRACE_DEBUG, "ch %d, mode %d", channel, mode);
 }
 
 void setFrequency(volatile uint32_t channel, volatile uint32_t frequency)
 {
     if (channel == 0)
     {
-        *(base + OFS_FREQA) = frequency; // Write the modified value back to the register
-        printd("ch %d, frA %d frA_set %d", channel, frequency, *(base + OFS_FREQA));
+        writeReg(OFS_FREQA, frequency); // Write the modified value back to the register
+        trace(TRACE_DEBUG, "ch %d, frA %d", channel, frequency);
     }
     if (channel == 1)
     {
-        *(base + OFS_FREQB) = frequency; // Write the modified value back to the register
-        printd("ch %d, frB %d frBset %d", channel, frequency, *(base + OFS_FREQB));
+        writeReg(OFS_FREQB, frequency); // Write the modified value back to the register
+        trace(TRACE_DEBUG, "ch %d, frB %d", channel, frequency);
     }
 }
 
@@ -111,7 +200,7 @@ void setDutyCycle(volatile uint32_t channel, volatile uint32_t dutyCycle)
         dutyCycle = dutyCycle << 16;
     }
 
-    uint32_t regValue = *(base + OFS_DTYCYC); // Read the current register value
+    uint32_t regValue = readReg(OFS_DTYCYC); // Read the current register value
     if (channel == 0)
     {                            // Clear the existing duty cycle bits
         regValue &= ~0x0000FFFF; // Clear bits 15:0 for Channel A
@@ -121,8 +210,8 @@ void setDutyCycle(volatile uint32_t channel, volatile uint32_t dutyCycle)
         regValue &= 0x0000FFFF; // Clear bits 31:16 for Channel B
     }
     regValue |= dutyCycle;           // Set the new duty cycle bits
-    *(base + OFS_DTYCYC) = regValue; // Write the modified value back to the register
-    printd("ch %d, duty %d duty_set %d  ", channel, dutyCycle, *(base + OFS_DTYCYC));
+    writeReg(OFS_DTYCYC, regValue); // Write the modified value back to the register
+    trace(TRACE_DEBUG, "ch %d, duty %d", channel, dutyCycle);
 }
 
 void setAmplitude(volatile uint32_t channel, volatile uint32_t amplitude)
@@ -134,7 +223,7 @@ void setAmplitude(volatile uint32_t channel, volatile uint32_t amplitude)
         amplitude = amplitude << 16;
     }
 
-    uint32_t regValue = *(base + OFS_AMPLITUDE); // Read the current register value
+    uint32_t regValue = readReg(OFS_AMPLITUDE); // Read the current register value
     if (channel == 0)
     {                            // Clear the existing amplitude bits
         regValue &= ~0x0000FFFF; // Clear bits 15:0 for Channel A
@@ -145,8 +234,8 @@ void setAmplitude(volatile uint32_t channel, volatile uint32_t amplitude)
     }
 
     regValue |= amplitude;              // Set the new amplitude bits
-    *(base + OFS_AMPLITUDE) = regValue; // Write the modified value back to the register
-    printd("ch %d, amp %d ampsetVal %d", channel, amplitude, *(base + OFS_AMPLITUDE));
+    writeReg(OFS_AMPLITUDE, regValue); // Write the modified value back to the register
+    trace(TRACE_DEBUG, "ch %d, amp %d", channel, amplitude);
 }
 
 void setOffset(volatile uint32_t channel, volatile int32_t offset_fp)
@@ -158,7 +247,7 @@ void setOffset(volatile uint32_t channel, volatile int32_t offset_fp)
         offset = offset << 16;
     }
 
-    uint32_t regValue = *(base + OFS_OFFSET); // Read the current register value
+    uint32_t regValue = readReg(OFS_OFFSET); // Read the current register value
 
     if (channel == 0)
     {                            // Clear the existing offset bits for the specified channel
@@ -170,8 +259,8 @@ void setOffset(volatile uint32_t channel, volatile int32_t offset_fp)
     }
 
     regValue |= (uint32_t)offset;    // Set the new offset bits for the specified channel
-    *(base + OFS_OFFSET) = regValue; // Write the modified value back to the register
-    printd("ch %d, off %d, ofs_set %d", channel, offset, *(base + OFS_OFFSET));
+    writeReg(OFS_OFFSET, regValue); // Write the modified value back to the register
+    trace(TRACE_DEBUG, "ch %d, off %d", channel, offset);
 }
 
 void setCycles(volatile uint32_t channel, volatile uint32_t cycles)
@@ -183,7 +272,7 @@ void setCycles(volatile uint32_t channel, volatile uint32_t cycles)
         cycles = cycles << 16;
     }
 
-    uint32_t regValue = *(base + OFS_CYCLES); // Read the current register value
+    uint32_t regValue = readReg(OFS_CYCLES); // Read the current register value
 
     if (channel == 0)
     {                            // Clear the existing cycles bits
@@ -195,8 +284,8 @@ void setCycles(volatile uint32_t channel, volatile uint32_t cycles)
     }
 
     regValue |= cycles;              // Set the new cycles bits
-    *(base + OFS_CYCLES) = regValue; // Write the modified value back to the register
-    printd("ch %d, cyc %d cyc_set %d", channel, cycles, *(base + OFS_CYCLES));
+    writeReg(OFS_CYCLES, regValue); // Write the modified value back to the register
+    trace(TRACE_DEBUG, "ch %d, cyc %d", channel, cycles);
 }
 void setRun(volatile uint32_t channel, volatile uint32_t run)
 {
@@ -207,23 +296,97 @@ void setRun(volatile uint32_t channel, volatile uint32_t run)
         run = run << 1;
     }
 
-    uint32_t regValue = *(base + OFS_RUN); // Read the current register value
+    uint32_t regValue = readReg(OFS_RUN); // Read the current register value
 
     regValue &= ~(1 << channel); // Clear the existing run bit for the specified channel
 
     regValue |= run; // Set the new run bit for the specified channel
 
-    *(base + OFS_RUN) = regValue; // Write the modified value back to the register
-    printd("ch %d, run %d", channel, run);
+    writeReg(OFS_RUN, regValue); // Write the modified value back to the register
+    trace(TRACE_DEBUG, "ch %d, run %d", channel, run);
+}
+
+// Phase offset, 2^16 = 360 degrees: channel A in bits 31:16 of OFS_MODE, B of OFS_RUN
+void setPhase(volatile uint32_t channel, volatile uint32_t phase)
+{
+    uint32_t offset = (channel == 1) ? OFS_RUN : OFS_MODE;
+    uint32_t regValue = readReg(offset);
+
+    regValue &= 0x0000FFFF;             // Clear the phase bits 31:16
+    regValue |= (phase & 0xFFFF) << 16; // Set the new phase
+    writeReg(offset, regValue);
+    trace(TRACE_DEBUG, "ch %d, phase %d", channel, phase);
+}
+
+// Hilbert flag, bit 6 (A) or 7 (B) of OFS_MODE
+void setHilbert(volatile uint32_t channel, volatile uint32_t hilbert)
+{
+    uint32_t regValue = readReg(OFS_MODE);
+
+    regValue &= ~(1 << (6 + channel));
+    if (hilbert)
+        regValue |= 1 << (6 + channel);
+    writeReg(OFS_MODE, regValue);
+    trace(TRACE_DEBUG, "ch %d, hilbert %d", channel, hilbert);
+}
+
+// Complement flag, bit 2 (A) or 3 (B) of OFS_RUN
+void setComplement(volatile uint32_t channel, volatile uint32_t complement)
+{
+    uint32_t regValue = readReg(OFS_RUN);
+
+    regValue &= ~(1 << (2 + channel));
+    if (complement)
+        regValue |= 1 << (2 + channel);
+    writeReg(OFS_RUN, regValue);
+    trace(TRACE_DEBUG, "ch %d, comp %d", channel, complement);
+}
+
+void setSampleRate(volatile uint32_t rate)
+{
+    if (rate < SRATE_MIN)
+        rate = SRATE_MIN;
+    if (rate > SRATE_MAX)
+        rate = SRATE_MAX;
+
+    writeReg(OFS_SRATE, rate); // Shared by both channels, every generator step follows it
+    trace(TRACE_DEBUG, "rate %d", rate);
+}
+
+void setArbSamples(volatile uint32_t channel, const int16_t *samples, uint32_t count)
+{
+    uint32_t *table = base + OFS_ARB(channel);
+    uint32_t i;
+
+    if (count > ARB_SAMPLES)
+        count = ARB_SAMPLES;
+
+    // One word per sample, tables are not staged by waveGenBegin()
+    for (i = 0; i < count; i++)
+        table[i] = (uint16_t)samples[i];
+
+    trace(TRACE_DEBUG, "ch %d, samples %d", channel, count);
 }
 
 void getStatus()
 {
     uint8_t i;
     uint32_t regVal;
-    for (i = 0; i < 8; i++)
+    for (i = 0; i < REGISTER_COUNT; i++)
     {
         regVal = *(base + i);
         printf("register offset: %d regVal: %d\n", i, regVal);
     }
-}
\ No newline at end of file
+}
+
+void waveGenTraceDump()
+{
+    char line[128];
+    uint32_t i, last = traceLast(&wavegenTrace);
+
+    for (i = traceFirst(&wavegenTrace); i <= last && last != 0; i++)
+    {
+        if (traceLine(&wavegenTrace, i, line, sizeof(line)))
+            fputs(line, stdout);
+    }
+}
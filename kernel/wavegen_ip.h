@@ -7,6 +7,7 @@
 #include <stdbool.h>
 
 bool waveGenOpen();
+bool waveGenOpenFile(const char *path);
 
 #endif
 void setChannelMode(volatile uint32_t channel, volatile uint32_t mode);
@@ -16,4 +17,12 @@ void setAmplitude(volatile uint32_t channel, volatile uint32_t amplitude);
 void setOffset(volatile uint32_t channel, volatile int32_t offset_fp);
 void setCycles(volatile uint32_t channel, volatile uint32_t cycles);
 void setRun(volatile uint32_t channel, volatile uint32_t run);
-void getStatus();
\ No newline at end of file
+void setPhase(volatile uint32_t channel, volatile uint32_t phase);
+void setHilbert(volatile uint32_t channel, volatile uint32_t hilbert);
+void setComplement(volatile uint32_t channel, volatile uint32_t complement);
+void setSampleRate(volatile uint32_t rate);
+void setArbSamples(volatile uint32_t channel, const int16_t *samples, uint32_t count);
+void waveGenBegin();
+void waveGenCommit();
+void getStatus();
+void waveGenTraceDump();
\ No newline at end of file
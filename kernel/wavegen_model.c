@@ -0,0 +1,238 @@
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: any host (no hardware required)
+
+// Golden model of the sample pipeline:
+//   Every statement below mirrors one register stage of
+//   version_2/samplePipeline.sv, sineLut.sv or stepCalc.sv; the comments
+//   name the RTL signal it computes. Signed right shifts are arithmetic
+//   (gcc, clang), like >>> on signed vectors.
+
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>         // C99 integer types -- uint32_t
+#include <stdbool.h>        // bool
+#include <string.h>         // memset
+#include <math.h>           // sin, log, tan
+#include "wavegen_model.h"  // model state
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+#define PI 3.14159265358979323846
+#define FRAC_BITS 12                // sineLut interpolation bits
+#define DEFAULT_FP_SCALE 14         // Q14 gain
+#define CALIBRATION_SCALE 11        // Calibration slope, 2048 = 1
+
+// sineLut table_R: quarter sine, then the Hilbert transform of the triangle
+static int16_t sineTable[2 * MODEL_SINE_ENTRIES];
+static bool sineReady = false;
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+// Same real arithmetic as the initial block of sineLut, $rtoi truncates
+static void sineTableInit()
+{
+    double x, t, last = 0.0, smooth = 0.0;
+    int i;
+
+    for (i = 0; i < MODEL_SINE_ENTRIES; i++)
+    {
+        x = 2.0 * PI * (i + 0.5) / 4096.0;
+        sineTable[i] = (int16_t)(int)(16383.0 * sin(x) + 0.5);
+
+        t      = (last + x) / 2.0;
+        smooth = smooth + (x - last) * log(tan(t / 2.0) / (t / 2.0));
+        last   = x;
+        sineTable[MODEL_SINE_ENTRIES + i] = (int16_t)-(int)(16383.0 * 4.0 / (PI * PI) * (x - x * log(x / 2.0) - smooth) + 0.5);
+    }
+    sineReady = true;
+}
+
+// Quarter table entry of a 12 bit index, negated in the second half wave
+static int32_t sineFold(uint32_t k, bool hilbert)
+{
+    uint32_t addr = (k & 0x400) ? (~k & 0x3FF) : (k & 0x3FF);
+    int32_t data = sineTable[(hilbert ? MODEL_SINE_ENTRIES : 0) + addr];
+
+    return (k & 0x800) ? -data : data;
+}
+
+int16_t modelSine(uint32_t phase, bool hilbert)
+{
+    uint32_t phase_c = phase - 0x00080000;
+    uint32_t k0 = phase_c >> 20;
+    uint32_t k1 = (k0 + 1) & 0xFFF;
+    uint32_t frac = (phase_c >> (20 - FRAC_BITS)) & ((1 << FRAC_BITS) - 1);
+    int32_t s0, s1, slope;
+
+    if (!sineReady)
+        sineTableInit();
+
+    s0 = sineFold(k0, hilbert);
+    s1 = sineFold(k1, hilbert);
+    slope = (s1 - s0) * (int32_t)frac + (1 << (FRAC_BITS - 1));
+
+    return (int16_t)(s0 + (slope >> FRAC_BITS));
+}
+
+uint32_t modelDeltaPhase(uint32_t frequency, uint32_t rate)
+{
+    // stepCalc: freq * (2^32 - 1) / srate, 0 = power up rate
+    if (rate == 0)
+        rate = SRATE_DEFAULT;
+    return (uint32_t)(((uint64_t)frequency * 0xFFFFFFFFull) / rate);
+}
+
+uint16_t modelSampleLoad(uint32_t rate)
+{
+    if (rate == 0)
+        rate = SRATE_DEFAULT;
+    return (uint16_t)(50000000 / rate);
+}
+
+void modelInit(WaveModel *model, uint32_t channels)
+{
+    uint32_t i;
+
+    memset(model, 0, sizeof(*model));
+    model->channels = (channels > WAVEGEN_MAX_CHANNELS) ? WAVEGEN_MAX_CHANNELS : channels;
+
+    // Calibration of wavegen_system_top, nominal past the first DAC
+    for (i = 0; i < WAVEGEN_MAX_CHANNELS; i++)
+    {
+        model->ch[i].calSlope     = (i == 0) ? 1961 : (i == 1) ? 1947 : 2048;
+        model->ch[i].calIntercept = (i == 0) ? 24   : (i == 1) ? 33   : 0;
+    }
+
+    if (!sineReady)
+        sineTableInit();
+}
+
+void modelArbWrite(WaveModel *model, uint32_t channel, uint32_t index, int16_t sample)
+{
+    if (channel < model->channels && index < ARB_SAMPLES)
+        model->arb[channel][index] = sample;
+}
+
+// hold: channel reads phase 0 this sample
+static bool modelHold(const WaveModel *model, const bool *sync, uint32_t c)
+{
+    return sync[c] || (model->ch[c].cycles != 0 && !model->active[c]);
+}
+
+static int16_t modelShape(const WaveModel *model, uint32_t c, uint32_t phase)
+{
+    const ModelChannel *ch = &model->ch[c];
+    uint32_t duty = (ch->duty == 0) ? 8192 : ch->duty;
+    uint32_t fold = (phase & 0x80000000) ? (~phase >> 15) & 0xFFFF : (phase >> 15) & 0xFFFF;
+
+    switch (ch->mode)
+    {
+        case 1:
+            // Sine 90 degrees behind for the Hilbert output
+            return modelSine(ch->hilbert ? phase - 0x40000000 : phase, false);
+        case 2:
+            return (int16_t)((phase >> 16) ^ 0x8000) >> 1;
+        case 3:
+            if (ch->hilbert)
+                return modelSine(phase, true);
+            return (int16_t)(fold ^ 0x8000) >> 1;
+        case 4:
+            return ((phase >> 18) < duty) ? 16384 : -16384;
+        case 5:
+            return model->arb[c][phase >> (32 - MODEL_ARB_BITS)];
+        default:
+            return 0;
+    }
+}
+
+void modelSample(WaveModel *model, uint16_t *words)
+{
+    bool sync[WAVEGEN_MAX_CHANNELS];
+    bool trig[WAVEGEN_MAX_CHANNELS];
+    uint32_t own[WAVEGEN_MAX_CHANNELS];
+    bool extRise = model->trigExt && !model->lastExt;
+    uint32_t c, pair, now, pairOwn, read;
+    uint64_t next;
+    int32_t shape, gained;
+    int16_t sampleSigned;
+    uint32_t sampleGained;
+    ModelChannel *ch;
+
+    // sync_R and trig_R: edges since the previous sampling pulse
+    for (c = 0; c < model->channels; c++)
+    {
+        ch = &model->ch[c];
+        sync[c] = ch->run && !model->lastRun[c];
+        trig[c] = (ch->trigger != model->lastTrigger[c]) || (extRise && ch->extEnable);
+        model->lastRun[c] = ch->run;
+        model->lastTrigger[c] = ch->trigger;
+    }
+    model->lastExt = model->trigExt;
+
+    // Channels in issue order
+    for (c = 0; c < model->channels; c++)
+    {
+        ch = &model->ch[c];
+
+        // phase_now, phase_next (bit 32 is a wrap), phase_own
+        now = modelHold(model, sync, c) ? 0 : model->phase[c];
+        next = (uint64_t)now + ch->deltaPhase;
+        own[c] = now + ((uint32_t)ch->phase << 16);
+
+        // pair_own: already issued for odd channels, read ahead for even ones
+        pair = c ^ 1;
+        if (pair >= model->channels)
+            pairOwn = own[c];
+        else if (pair < c)
+            pairOwn = own[pair];
+        else
+            pairOwn = (modelHold(model, sync, pair) ? 0 : model->phase[pair]) + ((uint32_t)model->ch[pair].phase << 16);
+
+        read = ch->hilbert ? pairOwn + ((uint32_t)ch->phase << 16) : own[c];
+
+        // Accumulator and burst counter
+        if (ch->cycles == 0)
+        {
+            model->phase[c] = (uint32_t)next;
+            model->active[c] = false;
+        }
+        else if (model->active[c])
+        {
+            if ((next >> 32) && (uint16_t)(model->count[c] + 1) == ch->cycles)
+            {
+                model->phase[c] = 0;
+                model->active[c] = false;
+                model->done ^= 1u << c;
+            }
+            else
+            {
+                model->phase[c] = (uint32_t)next;
+                model->count[c] += (uint16_t)(next >> 32);
+            }
+        }
+        else if (trig[c])
+        {
+            model->phase[c] = (uint32_t)next;
+            model->count[c] = 0;
+            model->active[c] = true;
+        }
+        else
+        {
+            model->phase[c] = 0;
+        }
+
+        // shape, gained, sample_signed, sample_gained, sample_unsigned
+        shape = modelShape(model, c, read);
+        gained = (shape * ch->amplitude) >> DEFAULT_FP_SCALE;
+        sampleSigned = (int16_t)((gained + ch->offset) >> 3);
+        sampleGained = (uint32_t)(sampleSigned * ch->calSlope) >> CALIBRATION_SCALE;
+        words[c] = (uint16_t)((sampleGained + (ch->calIntercept & 0xFFF) + 2048) & 0xFFF);
+    }
+}
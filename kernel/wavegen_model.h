@@ -0,0 +1,77 @@
+// WAVEGEN golden model
+// Bit accurate model of version_2/samplePipeline.sv and sineLut.sv
+
+//-----------------------------------------------------------------------------
+// Model:
+//   modelSample() is one sampling pulse: every channel is computed in issue
+//   order with the same integer widths, shifts and truncations as the RTL
+//   (phase accumulator, sineLut interpolation, shapes, Q14 gain >>> 14,
+//   offset >>> 3, calibration slope >> 11 plus intercept, 12 bit word).
+//   The words are dac_words of samplePipeline after that pulse; the top
+//   level latches them into the SPI engines on the next pulse.
+//   Inputs are the samplePipeline ports (raw register fields), changed
+//   between calls; run, trigger and external trigger edges are detected
+//   from one call to the next like the RTL does between sampling pulses.
+//-----------------------------------------------------------------------------
+
+#ifndef WAVEGEN_MODEL_H
+#define WAVEGEN_MODEL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "wavegenIp_regs.h" // WAVEGEN_MAX_CHANNELS, ARB_SAMPLES
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MODEL_ARB_BITS 10           // log2(ARB_SAMPLES)
+#define MODEL_SINE_ENTRIES 1024     // Quarter wave entries of each sineLut table
+
+// Inputs of one channel, as on the samplePipeline ports
+typedef struct
+{
+    uint8_t mode;                   // 0 dc, 1 sine, 2 saw, 3 tri, 4 sq, 5 arb, 6-7 nothing (0)
+    uint32_t deltaPhase;            // modelDeltaPhase(frequency, sample rate)
+    int16_t amplitude;              // Q14
+    int16_t offset;                 // Q14
+    uint16_t duty;                  // Q14 fraction of the period, 0 = 50%
+    uint16_t phase;                 // 2^16 = 360 degrees
+    bool run;                       // Rising edge restarts the channel at phase 0
+    bool hilbert;                   // Quadrature of the other channel of the pair
+    uint16_t cycles;                // Periods per burst, 0 = continuous
+    bool trigger;                   // Software trigger, toggled once per trigger
+    bool extEnable;                 // Started by the external trigger
+    int16_t calSlope;               // Gain 2048 = 1
+    uint16_t calIntercept;          // DAC codes, 12 bits
+} ModelChannel;
+
+typedef struct
+{
+    uint32_t channels;
+    bool trigExt;                   // External trigger level
+    ModelChannel ch[WAVEGEN_MAX_CHANNELS];
+
+    // Pipeline state
+    uint32_t phase[WAVEGEN_MAX_CHANNELS];
+    bool active[WAVEGEN_MAX_CHANNELS];
+    uint16_t count[WAVEGEN_MAX_CHANNELS];
+    uint32_t done;                  // burst_done, bit n toggles per finished burst
+    bool lastRun[WAVEGEN_MAX_CHANNELS];
+    bool lastTrigger[WAVEGEN_MAX_CHANNELS];
+    bool lastExt;
+    int16_t arb[WAVEGEN_MAX_CHANNELS][ARB_SAMPLES];
+} WaveModel;
+
+void modelInit(WaveModel *model, uint32_t channels);
+void modelSample(WaveModel *model, uint16_t *words);
+void modelArbWrite(WaveModel *model, uint32_t channel, uint32_t index, int16_t sample);
+int16_t modelSine(uint32_t phase, bool hilbert);
+uint32_t modelDeltaPhase(uint32_t frequency, uint32_t rate);
+uint16_t modelSampleLoad(uint32_t rate);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,404 @@
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: any Linux host (no hardware required)
+
+// Regression harness for the sample pipeline golden model (wavegen_model.c)
+//   stimulus writes register settings, one record per sampling pulse, which
+//   version_2/samplePipeline_tb.sv applies to the RTL while dumping
+//   dac_words and burst_done after every pulse. compare runs the model on
+//   the same stimulus and reports every sample where the dump differs.
+//
+//   Stimulus records (hex fields):
+//     header:       <channels> <records>
+//     arb write:    0 <channel> <index> <sample>
+//     sample pulse: 1 <trig_ext> then per channel <mode> <delta_phase>
+//                   <ampl> <dc_ofs> <duty> <phase_ofs> <run> <hilbert>
+//                   <cycles> <trig_sw> <trig_ext_en>
+//   Dump lines: <sample> <word 0> .. <word n-1> <burst_done>
+//
+// Build:
+//   gcc -O2 -o wavegen_model_check wavegen_model_check.c wavegen_model.c -lm
+// Run:
+//   ./wavegen_model_check stimulus [file] [channels]
+//   iverilog -g2012 -o tb samplePipeline_tb.sv samplePipeline.sv sineLut.sv arbWave.sv
+//   vvp tb +stimulus=[file] +dump=[rtl dump]
+//   ./wavegen_model_check compare [file] [rtl dump]
+//   ./wavegen_model_check expect [file] [model dump]
+//   ./wavegen_model_check bench [samples]
+//-----------------------------------------------------------------------------
+
+#include <stdlib.h>             // EXIT_ codes, strtoul
+#include <stdio.h>              // printf, fopen
+#include <stdint.h>             // C99 integer types -- uint32_t
+#include <stdbool.h>            // bool
+#include <string.h>             // strcmp
+#include <time.h>               // clock_gettime
+#include "wavegen_model.h"      // golden model
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+#define SCENARIO_SAMPLES 4096       // Sampling pulses per scenario
+#define MAX_MISMATCHES 10           // Mismatches printed by compare
+
+static uint32_t seed = 1;
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+static uint32_t randomWord()
+{
+    seed = seed * 1664525 + 1013904223;
+    return seed;
+}
+
+static void writeSample(FILE *file, const WaveModel *model)
+{
+    const ModelChannel *ch;
+    uint32_t c;
+
+    fprintf(file, "1 %x", model->trigExt);
+    for (c = 0; c < model->channels; c++)
+    {
+        ch = &model->ch[c];
+        fprintf(file, " %x %x %x %x %x %x %x %x %x %x %x",
+                ch->mode, ch->deltaPhase, (uint16_t)ch->amplitude, (uint16_t)ch->offset,
+                ch->duty, ch->phase, ch->run, ch->hilbert, ch->cycles, ch->trigger, ch->extEnable);
+    }
+    fprintf(file, "\n");
+}
+
+static void writeArb(FILE *file, WaveModel *model, uint32_t channel, uint32_t index, int16_t sample)
+{
+    fprintf(file, "0 %x %x %x\n", channel, index, (uint16_t)sample);
+    modelArbWrite(model, channel, index, sample);
+}
+
+// Plain settings of a channel: mode at frequency (Hz, 50 kHz sample rate)
+static void setChannel(WaveModel *model, uint32_t c, uint8_t mode, uint32_t frequency, int16_t amplitude, int16_t offset)
+{
+    ModelChannel *ch = &model->ch[c];
+
+    ch->mode = mode;
+    ch->deltaPhase = modelDeltaPhase(frequency, SRATE_DEFAULT);
+    ch->amplitude = amplitude;
+    ch->offset = offset;
+    ch->duty = 0;
+    ch->phase = 0;
+    ch->hilbert = false;
+    ch->cycles = 0;
+    ch->extEnable = false;
+    ch->run = true;
+}
+
+// Settings of channel c at sample n of a scenario
+static void scenarioStep(WaveModel *model, uint32_t scenario, uint32_t n, uint32_t c)
+{
+    ModelChannel *ch = &model->ch[c];
+
+    if (scenario < 6)
+    {
+        // Every mode, full scale on even channels, half scale with an offset on odd
+        if (n == 0)
+            setChannel(model, c, scenario, 1000 + 337 * c, (c & 1) ? 8192 : 16383, (c & 1) ? -4000 : 0);
+    }
+    else if (scenario == 6)
+    {
+        // Phase offsets and Hilbert pairs, sine then triangle
+        if (n == 0)
+        {
+            setChannel(model, c, 1, 1234, 16383, 0);
+            ch->phase = (uint16_t)(c * 0x2000);
+            ch->hilbert = (c & 1);
+        }
+        else if (n == SCENARIO_SAMPLES / 2)
+            ch->mode = 3;
+    }
+    else if (scenario == 7)
+    {
+        // Bursts, software trigger on even channels, external on odd ones
+        if (n == 0)
+        {
+            setChannel(model, c, 1 + c % 5, 5000, 12000, 100);
+            ch->cycles = 3 + c;
+            ch->extEnable = (c & 1);
+        }
+        else if (n % 200 == 10 && !(c & 1))
+            ch->trigger = !ch->trigger;
+    }
+    else if (n % 64 == 0)
+    {
+        // Random settings every 64 samples
+        ch->mode = randomWord() % 6;
+        ch->deltaPhase = randomWord();
+        ch->amplitude = (int16_t)randomWord();
+        ch->offset = (int16_t)randomWord();
+        ch->duty = randomWord() >> 16;
+        ch->phase = randomWord() >> 16;
+        ch->run = randomWord() & 1;
+        ch->hilbert = !(randomWord() & 3);
+        ch->cycles = (randomWord() & 3) ? 0 : randomWord() % 4;
+        ch->trigger ^= randomWord() & 1;
+        ch->extEnable = randomWord() & 1;
+    }
+
+    // Fixed scenarios restart every channel on their second sample
+    if (scenario < 8 && n < 2)
+        ch->run = (n == 1);
+}
+
+// Every scenario, SCENARIO_SAMPLES pulses each; the state of the previous
+// scenario carries over like it would on the board
+static uint32_t writeScenarios(FILE *file, uint32_t channels)
+{
+    WaveModel model;
+    uint32_t scenario, n, c, i, records = 0;
+
+    modelInit(&model, channels);
+
+    // Arbitrary tables: a ramp, with noise on every channel but 0
+    for (c = 0; c < channels; c++)
+    {
+        for (i = 0; i < ARB_SAMPLES; i++, records++)
+            writeArb(file, &model, c, i, (int16_t)(i * 32 - 16384 + (int8_t)(randomWord() >> 24) * (int)c));
+    }
+
+    for (scenario = 0; scenario < 9; scenario++)
+    {
+        for (n = 0; n < SCENARIO_SAMPLES; n++, records++)
+        {
+            for (c = 0; c < channels; c++)
+                scenarioStep(&model, scenario, n, c);
+
+            if (scenario == 7)          model.trigExt = (n % 300 > 150);
+            else if (scenario == 8)     model.trigExt = randomWord() & 1;
+            else                        model.trigExt = false;
+            writeSample(file, &model);
+        }
+    }
+    return records;
+}
+
+// Reads one record of a stimulus file into the model, false at the end
+static bool readRecord(FILE *file, WaveModel *model, bool *pulse)
+{
+    uint32_t kind, a, b, d, c;
+    uint32_t v[11];
+    ModelChannel *ch;
+
+    if (fscanf(file, "%x", &kind) != 1)
+        return false;
+
+    if (kind == 0)
+    {
+        if (fscanf(file, "%x %x %x", &a, &b, &d) != 3)
+            return false;
+        modelArbWrite(model, a, b, (int16_t)d);
+        *pulse = false;
+        return true;
+    }
+
+    if (fscanf(file, "%x", &a) != 1)
+        return false;
+    model->trigExt = a & 1;
+
+    for (c = 0; c < model->channels; c++)
+    {
+        if (fscanf(file, "%x %x %x %x %x %x %x %x %x %x %x",
+                   &v[0], &v[1], &v[2], &v[3], &v[4], &v[5], &v[6], &v[7], &v[8], &v[9], &v[10]) != 11)
+            return false;
+
+        ch = &model->ch[c];
+        ch->mode = v[0] & 7;
+        ch->deltaPhase = v[1];
+        ch->amplitude = (int16_t)v[2];
+        ch->offset = (int16_t)v[3];
+        ch->duty = v[4];
+        ch->phase = v[5];
+        ch->run = v[6] & 1;
+        ch->hilbert = v[7] & 1;
+        ch->cycles = v[8];
+        ch->trigger = v[9] & 1;
+        ch->extEnable = v[10] & 1;
+    }
+    *pulse = true;
+    return true;
+}
+
+static FILE *openStimulus(const char *path, WaveModel *model)
+{
+    FILE *file = fopen(path, "r");
+    uint32_t channels, records;
+
+    if (file == NULL || fscanf(file, "%x %x", &channels, &records) != 2 || channels > WAVEGEN_MAX_CHANNELS)
+    {
+        printf("%s: not a stimulus file\n", path);
+        exit(EXIT_FAILURE);
+    }
+    modelInit(model, channels);
+    return file;
+}
+
+static int stimulus(const char *path, uint32_t channels)
+{
+    FILE *file = fopen(path, "w");
+    uint32_t records;
+
+    if (channels == 0 || channels > WAVEGEN_MAX_CHANNELS)
+        channels = WAVEGEN_DEFAULT_CHANNELS;
+    if (file == NULL)
+    {
+        printf("%s: cannot create\n", path);
+        return EXIT_FAILURE;
+    }
+
+    // Header rewritten once the record count is known
+    fprintf(file, "%08x %08x\n", channels, 0);
+    records = writeScenarios(file, channels);
+    rewind(file);
+    fprintf(file, "%08x %08x\n", channels, records);
+    fclose(file);
+
+    printf("%s: %u channels, %u records\n", path, channels, records);
+    return EXIT_SUCCESS;
+}
+
+static int expect(const char *path, const char *dumpPath)
+{
+    WaveModel model;
+    FILE *file = openStimulus(path, &model);
+    FILE *dump = fopen(dumpPath, "w");
+    uint16_t words[WAVEGEN_MAX_CHANNELS];
+    uint32_t n = 0, c;
+    bool pulse;
+
+    if (dump == NULL)
+    {
+        printf("%s: cannot create\n", dumpPath);
+        return EXIT_FAILURE;
+    }
+
+    while (readRecord(file, &model, &pulse))
+    {
+        if (!pulse)
+            continue;
+
+        modelSample(&model, words);
+        fprintf(dump, "%u", n++);
+        for (c = 0; c < model.channels; c++)
+            fprintf(dump, " %03x", words[c]);
+        fprintf(dump, " %x\n", model.done);
+    }
+
+    fclose(file);
+    fclose(dump);
+    return EXIT_SUCCESS;
+}
+
+static int compare(const char *path, const char *dumpPath)
+{
+    WaveModel model;
+    FILE *file = openStimulus(path, &model);
+    FILE *dump = fopen(dumpPath, "r");
+    uint16_t words[WAVEGEN_MAX_CHANNELS];
+    uint32_t n = 0, index, word, done, c, mismatches = 0;
+    bool pulse, same;
+
+    if (dump == NULL)
+    {
+        printf("%s: cannot open\n", dumpPath);
+        return EXIT_FAILURE;
+    }
+
+    while (readRecord(file, &model, &pulse))
+    {
+        if (!pulse)
+            continue;
+
+        modelSample(&model, words);
+        if (fscanf(dump, "%u", &index) != 1 || index != n)
+        {
+            printf("sample %u: missing from %s\n", n, dumpPath);
+            return EXIT_FAILURE;
+        }
+
+        same = true;
+        for (c = 0; c < model.channels; c++)
+        {
+            if (fscanf(dump, "%x", &word) != 1)
+                word = ~0u;
+            if (word != words[c])
+            {
+                if (mismatches < MAX_MISMATCHES)
+                    printf("sample %u channel %u: rtl %03x, model %03x\n", n, c, word, words[c]);
+                same = false;
+            }
+        }
+        if (fscanf(dump, "%x", &done) != 1 || done != model.done)
+        {
+            if (mismatches < MAX_MISMATCHES)
+                printf("sample %u: burst_done rtl %x, model %x\n", n, done, model.done);
+            same = false;
+        }
+        mismatches += !same;
+        n++;
+    }
+
+    fclose(file);
+    fclose(dump);
+
+    printf("%u samples, %u mismatched: %s\n", n, mismatches, mismatches ? "failed" : "passed");
+    return mismatches ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+static int bench(uint32_t samples)
+{
+    WaveModel model;
+    uint16_t words[WAVEGEN_MAX_CHANNELS];
+    struct timespec start, end;
+    uint32_t n, c, sum = 0;
+    double seconds;
+
+    modelInit(&model, WAVEGEN_DEFAULT_CHANNELS);
+    for (c = 0; c < model.channels; c++)
+        setChannel(&model, c, 1 + c, 1000, 16383, 0);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (n = 0; n < samples; n++)
+    {
+        modelSample(&model, words);
+        sum += words[0] + words[1];
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) * 1e-9;
+    printf("%u samples x %u channels in %.3f s: %.1f M samples/s (%x)\n",
+           samples, model.channels, seconds, samples / seconds * 1e-6, sum);
+    return EXIT_SUCCESS;
+}
+
+//-----------------------------------------------------------------------------
+// Main
+//-----------------------------------------------------------------------------
+
+int main(int argc, char* argv[])
+{
+    if (argc >= 3 && strcmp(argv[1], "stimulus") == 0)
+        return stimulus(argv[2], (argc > 3) ? strtoul(argv[3], NULL, 0) : WAVEGEN_DEFAULT_CHANNELS);
+    if (argc == 4 && strcmp(argv[1], "expect") == 0)
+        return expect(argv[2], argv[3]);
+    if (argc == 4 && strcmp(argv[1], "compare") == 0)
+        return compare(argv[2], argv[3]);
+    if (argc >= 2 && strcmp(argv[1], "bench") == 0)
+        return bench((argc > 2) ? strtoul(argv[2], NULL, 0) : 10000000);
+
+    printf("usage: %s stimulus [file] [channels]\n", argv[0]);
+    printf("       %s expect [file] [model dump]\n", argv[0]);
+    printf("       %s compare [file] [rtl dump]\n", argv[0]);
+    printf("       %s bench [samples]\n", argv[0]);
+    return EXIT_FAILURE;
+}
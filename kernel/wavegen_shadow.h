@@ -0,0 +1,191 @@
+// WAVEGEN shadow register file
+// Shared by the kernel driver and the user space stress harness
+
+//-----------------------------------------------------------------------------
+// Hardware configuration:
+//   Channel A and B share packed registers (OFS_OFFSET, OFS_AMPLITUDE,
+//   OFS_DTYCYC and OFS_CYCLES hold A in bits 15:0 and B in bits 31:16,
+//   OFS_MODE and OFS_RUN hold fields of both channels), every channel
+//   shares OFS_RUN_MASK and the fields of OFS_CH_CTRL share one register,
+//   so every read-modify-write of a register is done under the device lock
+//   The shadow holds the global registers followed by every channel bank
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#ifndef WAVEGEN_SHADOW_H
+#define WAVEGEN_SHADOW_H
+
+#ifdef __KERNEL__
+#include <linux/types.h>    // uint32_t
+#include <linux/spinlock.h> // spinlock_t
+#include <asm/io.h>         // iowrite32, ioread32
+
+typedef spinlock_t wavegen_lock_t;
+
+#define wavegenLockInit(lock)           spin_lock_init(lock)
+#define wavegenLock(lock, flags)        spin_lock_irqsave(lock, flags)
+#define wavegenUnlock(lock, flags)      spin_unlock_irqrestore(lock, flags)
+#define wavegenMmioRead(addr)           ioread32(addr)
+#define wavegenMmioWrite(value, addr)   iowrite32(value, addr)
+#else
+#include <stdint.h>         // C99 integer types -- uint32_t
+#include <pthread.h>        // pthread_spinlock_t
+
+typedef pthread_spinlock_t wavegen_lock_t;
+
+#define wavegenLockInit(lock)           pthread_spin_init(lock, PTHREAD_PROCESS_PRIVATE)
+#define wavegenLock(lock, flags)        ((void)(flags), pthread_spin_lock(lock))
+#define wavegenUnlock(lock, flags)      ((void)(flags), pthread_spin_unlock(lock))
+#define wavegenMmioRead(addr)           (*(volatile uint32_t *)(addr))
+#define wavegenMmioWrite(value, addr)   (*(volatile uint32_t *)(addr) = (value))
+#endif
+
+#include "wavegenIp_regs.h"
+
+#define REGISTER_COUNT (SPAN_IN_BYTES / 4)
+#define SHADOW_COUNT (REGISTER_COUNT + WAVEGEN_MAX_CHANNELS * CHANNEL_STRIDE)
+
+// Register backend, either the IP on the AXI bus or plain memory standing in for it
+struct wavegen_bus
+{
+    uint32_t (*read)(uint32_t *base, unsigned int offset);
+    void (*write)(uint32_t *base, unsigned int offset, uint32_t value);
+};
+
+struct wavegen_device
+{
+    const struct wavegen_bus *bus;          // Register backend
+    uint32_t *base;                         // Mapped IP registers
+    uint32_t shadow[SHADOW_COUNT];          // Last value written to each register
+    wavegen_lock_t lock;                    // Serializes every shadow update
+};
+
+//-----------------------------------------------------------------------------
+// Register backends
+//-----------------------------------------------------------------------------
+
+static inline uint32_t mmioRead(uint32_t *base, unsigned int offset)
+{
+    return wavegenMmioRead(base + offset);
+}
+
+static inline void mmioWrite(uint32_t *base, unsigned int offset, uint32_t value)
+{
+    wavegenMmioWrite(value, base + offset);
+}
+
+static inline uint32_t memoryRead(uint32_t *base, unsigned int offset)
+{
+    return *(volatile uint32_t *)(base + offset);
+}
+
+static inline void memoryWrite(uint32_t *base, unsigned int offset, uint32_t value)
+{
+    *(volatile uint32_t *)(base + offset) = value;
+}
+
+// IP registers mapped from the AXI4-Lite bus
+static const struct wavegen_bus wavegenMmioBus = { mmioRead, mmioWrite };
+
+// In-memory register file mirroring the IP register map (no hardware)
+static const struct wavegen_bus wavegenMemoryBus = { memoryRead, memoryWrite };
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+/**
+ *      @brief Function to map a shadow entry to its register offset
+ *      @param index shadow entry, 0 to SHADOW_COUNT - 1
+ *      @return unsigned int register offset in the IP
+ **/
+static inline unsigned int shadowOffset(unsigned int index)
+{
+    return (index < REGISTER_COUNT) ? index : OFS_CHANNEL_BANK + index - REGISTER_COUNT;
+}
+
+/**
+ *      @brief Function to map a register offset to its shadow entry
+ *      @param offset global register or channel bank register
+ *      @return unsigned int shadow entry
+ **/
+static inline unsigned int shadowIndex(unsigned int offset)
+{
+    return (offset < OFS_CHANNEL_BANK) ? offset : REGISTER_COUNT + offset - OFS_CHANNEL_BANK;
+}
+
+/**
+ *      @brief Function to load the shadow registers from the IP
+ *                (Only bus read done by the driver, called once at init)
+ *      @param dev device to load, with bus and base already set
+ **/
+static inline void loadShadow(struct wavegen_device *dev)
+{
+    unsigned int i;
+
+    wavegenLockInit(&dev->lock);
+
+    for (i = 0; i < SHADOW_COUNT; i++)
+        dev->shadow[i] = dev->bus->read(dev->base, shadowOffset(i));
+}
+
+/**
+ *      @brief Function to update a shadow register and write it to the IP
+ *                (Caller holds dev->lock)
+ *      @param dev device to write
+ *      @param offset register to modify
+ *      @param clear bits to clear
+ *      @param set bits to set
+ **/
+static inline void writeShadow(struct wavegen_device *dev, unsigned int offset, uint32_t clear, uint32_t set)
+{
+    uint32_t *shadow = &dev->shadow[shadowIndex(offset)];
+
+    *shadow = (*shadow & ~clear) | set;
+    dev->bus->write(dev->base, offset, *shadow);
+}
+
+/**
+ *      @brief Function to modify fields of a register through the shadow copy
+ *      @param dev device to write
+ *      @param offset register to modify
+ *      @param clear bits to clear
+ *      @param set bits to set
+ **/
+static inline void modifyRegister(struct wavegen_device *dev, unsigned int offset, uint32_t clear, uint32_t set)
+{
+    unsigned long flags = 0;
+
+    wavegenLock(&dev->lock, flags);
+    writeShadow(dev, offset, clear, set);
+    wavegenUnlock(&dev->lock, flags);
+}
+
+/**
+ *      @brief Function to set one channel's half of a shared 16 bit register
+ *      @param dev device to write
+ *      @param offset register to set
+ *      @param channel 0 = lower 16 bits, 1 = upper 16 bits
+ *      @param value 16 bit value to set
+ **/
+static inline void modifyHalf(struct wavegen_device *dev, unsigned int offset, int channel, uint32_t value)
+{
+    if      (channel == 0)  modifyRegister(dev, offset, 0x0000FFFF, value & 0x0000FFFF);
+    else if (channel == 1)  modifyRegister(dev, offset, 0xFFFF0000, value << 16);
+}
+
+/**
+ *      @brief Function to read a register from the shadow copy
+ *      @param dev device to read
+ *      @param offset register to read
+ *      @return uint32_t register value
+ **/
+static inline uint32_t readRegister(struct wavegen_device *dev, unsigned int offset)
+{
+    return *(volatile uint32_t *)&dev->shadow[shadowIndex(offset)];
+}
+
+#endif
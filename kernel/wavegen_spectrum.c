@@ -0,0 +1,440 @@
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: any Linux host (no hardware required)
+
+// Spectral benchmark of the DAC words
+//   Runs sine, sawtooth, triangle and square over a grid of frequencies and
+//   amplitudes through the golden model (wavegen_model.c), or reads one
+//   channel of a wavegen_sim -o / wavegen_spi_decode -o file, and measures
+//   from a Blackman-Harris windowed FFT of the 12 bit words:
+//     SFDR    fundamental to the largest spur (dBc)
+//     THD     harmonics 2 to HARMONICS, aliases folded (dBc)
+//     SINAD   signal to everything else but DC (dB), and ENOB
+//   For saw, triangle and square the harmonics below Nyquist are part of
+//   the signal, so SFDR and SINAD measure the aliases and the noise only.
+//     error   measured minus requested frequency (Hz)
+//   The FFT keeps real and imaginary parts in separate arrays and the
+//   twiddles of each pass contiguous, so the butterflies vectorize (-O3).
+//
+// Build:
+//   gcc -O3 -o wavegen_spectrum wavegen_spectrum.c wavegen_model.c -lm
+// Run:
+//   ./wavegen_spectrum [-n points] [-r rate] [-j report.json]
+//   ./wavegen_spectrum -f samples.txt -c channel -F frequency [-r rate] [-j report.json]
+//-----------------------------------------------------------------------------
+
+#include <stdlib.h>             // EXIT_ codes, malloc
+#include <stdio.h>              // printf, fopen
+#include <stdint.h>             // C99 integer types -- uint32_t
+#include <stdbool.h>            // bool
+#include <string.h>             // strcmp
+#include <math.h>               // sin, cos, log10
+#include <unistd.h>             // getopt
+#include "wavegen_model.h"      // golden model
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+#define PI 3.14159265358979323846
+#define LOBE_BINS 6                 // Half width of a windowed tone
+#define DC_BINS 6
+#define CENTROID_BINS 3             // Frequency from the top of the lobe only
+#define HARMONICS 10
+#define SETTLE_SAMPLES 16           // Model samples dropped after the start
+#define MAX_RESULTS 128
+
+typedef struct
+{
+    const char *source;
+    uint32_t mode;
+    double frequency;               // Requested (Hz)
+    int32_t amplitude;              // Q14, 0 for files
+    double measured;                // Fundamental (Hz)
+    double sfdr, thd, sinad, enob;
+} SpectrumResult;
+
+static const char *const modeNames[] = { "dc", "sine", "saw", "tri", "sq", "arb" };
+
+// FFT buffers and tables of the current size
+static uint32_t points = 0;
+static float *re, *im, *window, *twiddleRe, *twiddleIm, *power;
+static uint32_t *reverse;
+
+static SpectrumResult results[MAX_RESULTS];
+static uint32_t resultCount = 0;
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+static bool fftInit(uint32_t n)
+{
+    uint32_t i, bits = 0, half, k;
+
+    if (n < 64 || (n & (n - 1)))
+        return false;
+    while ((1u << bits) < n)
+        bits++;
+
+    points    = n;
+    re        = aligned_alloc(64, n * sizeof(float));
+    im        = aligned_alloc(64, n * sizeof(float));
+    window    = aligned_alloc(64, n * sizeof(float));
+    power     = aligned_alloc(64, n * sizeof(float));
+    twiddleRe = aligned_alloc(64, n * sizeof(float));
+    twiddleIm = aligned_alloc(64, n * sizeof(float));
+    reverse   = malloc(n * sizeof(uint32_t));
+
+    for (i = 0; i < n; i++)
+    {
+        // 4 term Blackman-Harris, sidelobes below -92 dB
+        double x = 2.0 * PI * i / n;
+        window[i] = 0.35875 - 0.48829 * cos(x) + 0.14128 * cos(2 * x) - 0.01168 * cos(3 * x);
+
+        reverse[i] = 0;
+        for (k = 0; k < bits; k++)
+            reverse[i] |= ((i >> k) & 1) << (bits - 1 - k);
+    }
+
+    // Twiddles of the pass with half size h at [h, 2h)
+    for (half = 1; half < n; half <<= 1)
+    {
+        for (k = 0; k < half; k++)
+        {
+            twiddleRe[half + k] = (float)cos(-PI * k / half);
+            twiddleIm[half + k] = (float)sin(-PI * k / half);
+        }
+    }
+    return true;
+}
+
+// In place radix 2 decimation in time, input already bit reversed
+static void fft(float *restrict xr, float *restrict xi)
+{
+    uint32_t half, block, k;
+
+    for (half = 1; half < points; half <<= 1)
+    {
+        const float *restrict wr = twiddleRe + half;
+        const float *restrict wi = twiddleIm + half;
+
+        for (block = 0; block < points; block += 2 * half)
+        {
+            float *restrict ar = xr + block, *restrict ai = xi + block;
+            float *restrict br = ar + half, *restrict bi = ai + half;
+
+            for (k = 0; k < half; k++)
+            {
+                float tr = br[k] * wr[k] - bi[k] * wi[k];
+                float ti = br[k] * wi[k] + bi[k] * wr[k];
+                br[k] = ar[k] - tr;
+                bi[k] = ai[k] - ti;
+                ar[k] = ar[k] + tr;
+                ai[k] = ai[k] + ti;
+            }
+        }
+    }
+}
+
+// Power of every bin up to Nyquist from 12 bit words
+static void spectrum(const uint16_t *words)
+{
+    double mean = 0;
+    uint32_t i;
+
+    for (i = 0; i < points; i++)
+        mean += words[i];
+    mean /= points;
+
+    for (i = 0; i < points; i++)
+    {
+        re[reverse[i]] = (float)((words[i] - mean) * window[i]);
+        im[reverse[i]] = 0.0f;
+    }
+    fft(re, im);
+
+    for (i = 0; i <= points / 2; i++)
+        power[i] = re[i] * re[i] + im[i] * im[i];
+}
+
+// Bin of frequency f folded into 0 .. Nyquist
+static uint32_t foldBin(double f, double rate)
+{
+    f = fmod(f, rate);
+    if (f > rate / 2)
+        f = rate - f;
+    return (uint32_t)lround(f / rate * points);
+}
+
+static double lobePower(uint32_t bin, bool *used)
+{
+    uint32_t lo = (bin > LOBE_BINS) ? bin - LOBE_BINS : 0;
+    uint32_t hi = (bin + LOBE_BINS < points / 2) ? bin + LOBE_BINS : points / 2;
+    double sum = 0;
+    uint32_t i;
+
+    for (i = lo; i <= hi; i++)
+    {
+        if (!used[i])
+            sum += power[i];
+        used[i] = true;
+    }
+    return sum;
+}
+
+static void analyze(SpectrumResult *result, double rate)
+{
+    uint32_t half = points / 2;
+    bool *used = calloc(half + 1, sizeof(bool));
+    bool *shape = calloc(half + 1, sizeof(bool));
+    uint32_t i, k, peak, lo, hi, bin;
+    double fundamental, harmonics = 0, signal, noise = 0, spur = 0, sum = 0, moment = 0;
+
+    for (i = 0; i <= DC_BINS; i++)
+        used[i] = true;
+
+    // Fundamental: largest bin near the request, centroid of the top of its lobe
+    bin = foldBin(result->frequency, rate);
+    lo = (bin > DC_BINS + 4 * LOBE_BINS) ? bin - 4 * LOBE_BINS : DC_BINS + 1;
+    hi = (bin + 4 * LOBE_BINS < half) ? bin + 4 * LOBE_BINS : half;
+    for (i = peak = lo; i <= hi; i++)
+    {
+        if (power[i] > power[peak])
+            peak = i;
+    }
+    for (i = peak - CENTROID_BINS; i <= peak + CENTROID_BINS && i <= half; i++)
+    {
+        sum += power[i];
+        moment += power[i] * i;
+    }
+    result->measured = moment / sum * rate / points;
+    fundamental = lobePower(peak, used);
+
+    for (k = 2; k <= HARMONICS; k++)
+    {
+        bin = foldBin(k * result->measured, rate);
+        if (bin > DC_BINS && !used[bin])
+            harmonics += lobePower(bin, used);
+    }
+
+    // The in band harmonics of the other shapes belong to the signal
+    for (k = 2; result->mode != 1 && k * result->measured < rate / 2; k++)
+    {
+        bin = foldBin(k * result->measured, rate);
+        for (i = (bin > LOBE_BINS) ? bin - LOBE_BINS : 0; i <= bin + LOBE_BINS && i <= half; i++)
+            shape[i] = true;
+    }
+
+    signal = fundamental;
+    for (i = DC_BINS + 1; i <= half; i++)
+    {
+        if (i + LOBE_BINS >= peak && i <= peak + LOBE_BINS)
+            continue;
+        if (shape[i])
+            signal += power[i];
+        else
+        {
+            noise += power[i];
+            if (power[i] > spur)
+                spur = power[i];
+        }
+    }
+
+    result->sfdr  = 10 * log10(power[peak] / (spur > 0 ? spur : 1e-30));
+    result->thd   = 10 * log10((harmonics > 0 ? harmonics : 1e-30) / fundamental);
+    result->sinad = 10 * log10(signal / (noise > 0 ? noise : 1e-30));
+    result->enob  = (result->sinad - 1.76) / 6.02;
+
+    free(used);
+    free(shape);
+}
+
+static void printResult(const SpectrumResult *r)
+{
+    printf("%-6s %-4s %10.1f %6d %12.4f %8.2f %8.2f %8.2f %6.2f\n", r->source, modeNames[r->mode],
+           r->frequency, r->amplitude, r->measured - r->frequency, r->sfdr, r->thd, r->sinad, r->enob);
+}
+
+static void modelRun(uint32_t mode, double frequency, int32_t amplitude, uint32_t rate, uint16_t *words)
+{
+    WaveModel model;
+    uint16_t out[WAVEGEN_MAX_CHANNELS];
+    uint32_t i;
+
+    modelInit(&model, WAVEGEN_DEFAULT_CHANNELS);
+    model.ch[0].mode = mode;
+    model.ch[0].deltaPhase = modelDeltaPhase((uint32_t)frequency, rate);
+    model.ch[0].amplitude = (int16_t)amplitude;
+    model.ch[0].run = true;
+
+    for (i = 0; i < SETTLE_SAMPLES + points; i++)
+    {
+        modelSample(&model, out);
+        if (i >= SETTLE_SAMPLES)
+            words[i - SETTLE_SAMPLES] = out[0];
+    }
+}
+
+// One channel of a "<time> <word 0> .. <word n-1>" file, the last points samples
+static bool readSamples(const char *path, uint32_t channel, uint16_t *words, double *rate)
+{
+    FILE *file = fopen(path, "r");
+    char line[512];
+    uint32_t count = 0, c;
+    double time, first = 0, last = 0;
+    char *p;
+    long value;
+
+    if (file == NULL)
+        return false;
+
+    while (fgets(line, sizeof(line), file))
+    {
+        time = strtod(line, &p);
+        for (c = 0; c <= channel; c++)
+            value = strtol(p, &p, 10);
+        words[count % points] = (uint16_t)value;
+        if (count == 0)
+            first = time;
+        last = time;
+        count++;
+    }
+    fclose(file);
+
+    if (count < points)
+    {
+        printf("%s: %u samples, %u needed\n", path, count, points);
+        return false;
+    }
+
+    // Oldest first
+    if (count % points)
+    {
+        uint16_t *copy = malloc(points * sizeof(uint16_t));
+        for (c = 0; c < points; c++)
+            copy[c] = words[(count + c) % points];
+        memcpy(words, copy, points * sizeof(uint16_t));
+        free(copy);
+    }
+
+    // Sample rate from the time stamps (ns) unless given
+    if (*rate == 0)
+        *rate = (count - 1) * 1e9 / (last - first);
+    return true;
+}
+
+static bool writeReport(const char *path, uint32_t rate)
+{
+    FILE *file = fopen(path, "w");
+    double worstSfdr = 1e9, worstSinad = 1e9;
+    uint32_t i;
+
+    if (file == NULL)
+        return false;
+
+    fprintf(file, "{\n  \"points\": %u,\n  \"rate\": %u,\n  \"results\": [\n", points, rate);
+    for (i = 0; i < resultCount; i++)
+    {
+        const SpectrumResult *r = &results[i];
+        fprintf(file, "    {\"source\": \"%s\", \"mode\": \"%s\", \"frequency\": %.3f, \"amplitude\": %d, "
+                      "\"frequency_error\": %.6f, \"sfdr_dbc\": %.3f, \"thd_dbc\": %.3f, \"sinad_db\": %.3f, \"enob\": %.3f}%s\n",
+                r->source, modeNames[r->mode], r->frequency, r->amplitude, r->measured - r->frequency,
+                r->sfdr, r->thd, r->sinad, r->enob, (i + 1 < resultCount) ? "," : "");
+        if (r->mode == 1 && r->sfdr < worstSfdr)
+            worstSfdr = r->sfdr;
+        if (r->mode == 1 && r->sinad < worstSinad)
+            worstSinad = r->sinad;
+    }
+    fprintf(file, "  ],\n  \"summary\": {\"worst_sine_sfdr_dbc\": %.3f, \"worst_sine_sinad_db\": %.3f}\n}\n",
+            worstSfdr, worstSinad);
+    fclose(file);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// Main
+//-----------------------------------------------------------------------------
+
+int main(int argc, char* argv[])
+{
+    static const uint32_t modes[] = { 1, 2, 3, 4 };
+    static const double frequencies[] = { 101, 997, 4999, 12345 };
+    static const int32_t amplitudes[] = { 16383, 4096, 1024 };
+    uint32_t n = 16384, rate = SRATE_DEFAULT, channel = 0, m, f, a;
+    double fileFrequency = 0, fileRate = 0;
+    const char *inPath = NULL, *jsonPath = NULL;
+    uint16_t *words;
+    int option;
+
+    while ((option = getopt(argc, argv, "n:r:f:c:F:j:")) != -1)
+    {
+        switch (option)
+        {
+            case 'n':   n = strtoul(optarg, NULL, 0);           break;
+            case 'r':   rate = strtoul(optarg, NULL, 0);
+                        fileRate = rate;                        break;
+            case 'f':   inPath = optarg;                        break;
+            case 'c':   channel = strtoul(optarg, NULL, 0);     break;
+            case 'F':   fileFrequency = strtod(optarg, NULL);   break;
+            case 'j':   jsonPath = optarg;                      break;
+            default:    return EXIT_FAILURE;
+        }
+    }
+
+    if (!fftInit(n))
+    {
+        printf("-n %u: power of 2 from 64 needed\n", n);
+        return EXIT_FAILURE;
+    }
+    words = malloc(points * sizeof(uint16_t));
+
+    printf("%-6s %-4s %10s %6s %12s %8s %8s %8s %6s\n", "source", "mode", "freq", "ampl", "error Hz", "SFDR", "THD", "SINAD", "ENOB");
+
+    if (inPath)
+    {
+        if (fileFrequency <= 0 || channel >= WAVEGEN_MAX_CHANNELS || !readSamples(inPath, channel, words, &fileRate))
+        {
+            printf("usage: %s -f samples.txt -c channel -F frequency [-r rate]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+        SpectrumResult *r = &results[resultCount++];
+        r->source = "file";
+        r->mode = 1;
+        r->frequency = fileFrequency;
+        spectrum(words);
+        analyze(r, fileRate);
+        printResult(r);
+        rate = (uint32_t)lround(fileRate);
+    }
+    else
+    {
+        for (m = 0; m < sizeof(modes) / sizeof(modes[0]); m++)
+        {
+            for (f = 0; f < sizeof(frequencies) / sizeof(frequencies[0]); f++)
+            {
+                for (a = 0; a < sizeof(amplitudes) / sizeof(amplitudes[0]); a++)
+                {
+                    SpectrumResult *r = &results[resultCount++];
+                    r->source = "model";
+                    r->mode = modes[m];
+                    r->frequency = frequencies[f];
+                    r->amplitude = amplitudes[a];
+                    modelRun(r->mode, r->frequency, r->amplitude, rate, words);
+                    spectrum(words);
+                    analyze(r, rate);
+                    printResult(r);
+                }
+            }
+        }
+    }
+
+    if (jsonPath && !writeReport(jsonPath, rate))
+    {
+        printf("%s: cannot create\n", jsonPath);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
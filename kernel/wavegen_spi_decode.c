@@ -0,0 +1,563 @@
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: any Linux host (no hardware required)
+
+// SPI decoder for DAC captures
+//   Rebuilds the DAC words sent by version_2/spiModule.sv from a trace of
+//   its pins: SDI is shifted in on rising CLK_SPI while CS_ is low, a 16 bit
+//   frame ({4'b0011, dacA} or {4'b1011, dacB}) ends on CS_ high and the
+//   falling edge of LDAC_ updates every DAC output, one sample per channel.
+//   Prints the achieved sample rate and the jitter of the LDAC_ period, and
+//   optionally the samples in the format of wavegen_sim -o:
+//     <time ns> <word 0> .. <word n-1>    (channel 2d = DAC d A, 2d + 1 = B)
+//
+//   Inputs, memory mapped so captures larger than memory stream through:
+//     VCD        (simulation, e.g. wavegen_sim -v), signals found by name
+//     binary     (logic analyzer raw export, e.g. sigrok "binary"), one
+//                unit of 1, 2 or 4 bytes per sample, one bit per probe
+//
+// Build:
+//   gcc -O2 -o wavegen_spi_decode wavegen_spi_decode.c -lm
+// Run:
+//   ./wavegen_spi_decode [options] capture.vcd
+//   ./wavegen_spi_decode -r 100e6 -p sclk=1,ldac=3,cs0=0,sdi0=2 capture.bin
+//     -r rate         binary sample rate in Hz (binary input)
+//     -u bytes        binary unit size, 1 (default), 2 or 4
+//     -p pin=n,...    binary probe of sclk, ldac, cs<d> and sdi<d>
+//                     (default sclk=1,ldac=3,cs0=0,sdi0=2)
+//     -n pin=name,... VCD signal names (default sclk=CLK_SPI,ldac=LDAC_,cs=CS_,sdi=SDI,
+//                     vectors hold one bit per DAC)
+//     -o file         decoded samples
+//-----------------------------------------------------------------------------
+
+#include <stdlib.h>             // EXIT_ codes, strtod
+#include <stdio.h>              // printf, fopen
+#include <stdint.h>             // C99 integer types -- uint32_t
+#include <stdbool.h>            // bool
+#include <string.h>             // strcmp, strncmp
+#include <math.h>               // sqrt
+#include <time.h>               // clock_gettime
+#include <fcntl.h>              // open
+#include <unistd.h>             // close, getopt
+#include <sys/mman.h>           // mmap, madvise
+#include <sys/stat.h>           // fstat
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+#define MAX_DACS 7                  // 14 channels
+#define FRAME_BITS 16
+#define NAME_LENGTH 64
+
+// Decoder state, pins are bits of one word: sclk, ldac, cs and sdi of each DAC
+typedef struct
+{
+    uint32_t sclk;                  // Pin masks
+    uint32_t ldac;
+    uint32_t cs[MAX_DACS];
+    uint32_t sdi[MAX_DACS];
+    uint32_t dacs;
+
+    uint32_t last;                  // Pins at the previous change
+    uint32_t shift[MAX_DACS];
+    uint32_t bits[MAX_DACS];
+    uint16_t word[MAX_DACS][2];     // DAC A, DAC B
+
+    double tick;                    // Seconds per time unit of the capture
+    uint64_t samples;
+    uint64_t frames;
+    uint64_t badFrames;             // Not 16 bits, or not a DAC A or B command
+    uint64_t lastTime;
+    double sum, sumSquares, minPeriod, maxPeriod;   // LDAC_ periods (s)
+    FILE *out;
+} SpiDecoder;
+
+static SpiDecoder spi;
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+// One LDAC_ falling edge: every channel has a new sample
+static void spiSample(SpiDecoder *dec, uint64_t time)
+{
+    uint32_t d;
+    double period;
+
+    if (dec->samples != 0)
+    {
+        period = (time - dec->lastTime) * dec->tick;
+        dec->sum += period;
+        dec->sumSquares += period * period;
+        if (period < dec->minPeriod)   dec->minPeriod = period;
+        if (period > dec->maxPeriod)   dec->maxPeriod = period;
+    }
+    dec->lastTime = time;
+    dec->samples++;
+
+    if (dec->out)
+    {
+        fprintf(dec->out, "%.0f", time * dec->tick * 1e9);
+        for (d = 0; d < dec->dacs; d++)
+            fprintf(dec->out, " %u %u", dec->word[d][0], dec->word[d][1]);
+        fprintf(dec->out, "\n");
+    }
+}
+
+// Pins changed from dec->last to pins at time
+static inline void spiChange(SpiDecoder *dec, uint64_t time, uint32_t pins)
+{
+    uint32_t rise = pins & ~dec->last;
+    uint32_t fall = ~pins & dec->last;
+    uint32_t d, frame;
+
+    for (d = 0; d < dec->dacs; d++)
+    {
+        if (fall & dec->cs[d])
+        {
+            dec->shift[d] = 0;
+            dec->bits[d] = 0;
+        }
+        else if ((rise & dec->sclk) && !(pins & dec->cs[d]))
+        {
+            dec->shift[d] = (dec->shift[d] << 1) | ((pins & dec->sdi[d]) != 0);
+            dec->bits[d]++;
+        }
+        else if (rise & dec->cs[d])
+        {
+            // 0011 = write DAC A, 1011 = write DAC B (gain 1x, active)
+            frame = dec->shift[d] & 0xFFFF;
+            dec->frames++;
+            if (dec->bits[d] == FRAME_BITS && (frame >> 12 & 0x7) == 0x3)
+                dec->word[d][frame >> 15] = frame & 0xFFF;
+            else
+                dec->badFrames++;
+        }
+    }
+
+    if (fall & dec->ldac)
+        spiSample(dec, time);
+
+    dec->last = pins;
+}
+
+// Binary capture: a run of unchanged units is skipped 8 bytes at a time
+static void decodeBinary(SpiDecoder *dec, const uint8_t *data, size_t size, uint32_t unit)
+{
+    uint64_t i, count = size / unit;
+    uint64_t repeat;
+    uint32_t pins;
+
+    if (count == 0)
+        return;
+
+    dec->last = (unit == 1) ? data[0] : (unit == 2) ? ((const uint16_t *)data)[0] : ((const uint32_t *)data)[0];
+
+    for (i = 1; i < count; i++)
+    {
+        if (unit == 1)
+        {
+            repeat = dec->last * 0x0101010101010101ull;
+            while (i + 8 <= count)
+            {
+                uint64_t chunk;
+                memcpy(&chunk, data + i, 8);
+                if (chunk != repeat)
+                    break;
+                i += 8;
+            }
+            if (i >= count)
+                break;
+            pins = data[i];
+        }
+        else if (unit == 2)
+            pins = ((const uint16_t *)data)[i];
+        else
+            pins = ((const uint32_t *)data)[i];
+
+        if (pins != dec->last)
+            spiChange(dec, i, pins);
+    }
+}
+
+// VCD time scale in seconds, e.g. "1ps" or "10 ns"
+static double vcdTimescale(const char *text)
+{
+    double value = strtod(text, (char **)&text);
+
+    while (*text == ' ' || *text == '\t' || *text == '\n' || *text == '\r')
+        text++;
+
+    if (strncmp(text, "fs", 2) == 0)   return value * 1e-15;
+    if (strncmp(text, "ps", 2) == 0)   return value * 1e-12;
+    if (strncmp(text, "ns", 2) == 0)   return value * 1e-9;
+    if (strncmp(text, "us", 2) == 0)   return value * 1e-6;
+    if (strncmp(text, "ms", 2) == 0)   return value * 1e-3;
+    return value;
+}
+
+// Signal of a VCD identifier code
+typedef struct
+{
+    char code[8];
+    uint32_t masks[MAX_DACS];       // Pin of each bit, LSB first
+    uint32_t width;
+} VcdSignal;
+
+static VcdSignal vcdSignals[4];
+static uint32_t vcdCount = 0;
+
+static bool isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+static const char *skipSpace(const char *p, const char *end)
+{
+    while (p < end && isSpace(*p))
+        p++;
+    return p;
+}
+
+static const char *token(const char *p, const char *end, char *text, size_t size)
+{
+    size_t n = 0;
+
+    p = skipSpace(p, end);
+    while (p < end && !isSpace(*p))
+    {
+        if (n + 1 < size)
+            text[n++] = *p;
+        p++;
+    }
+    text[n] = '\0';
+    return p;
+}
+
+static VcdSignal *vcdFind(const char *code, size_t length)
+{
+    uint32_t i;
+
+    for (i = 0; i < vcdCount; i++)
+    {
+        if (strlen(vcdSignals[i].code) == length && memcmp(vcdSignals[i].code, code, length) == 0)
+            return &vcdSignals[i];
+    }
+    return NULL;
+}
+
+// VCD capture: the first variable of each name in the header, then its changes
+static bool decodeVcd(SpiDecoder *dec, const char *p, size_t size, char names[4][NAME_LENGTH])
+{
+    const char *end = p + size;
+    char word[NAME_LENGTH], code[8], width[16], name[NAME_LENGTH];
+    uint64_t time = 0;
+    uint32_t pins = 0, found = 0, i, d;
+    bool changed = false;
+    VcdSignal *signal;
+
+    // Header
+    dec->tick = 1e-9;
+    while (p < end)
+    {
+        p = token(p, end, word, sizeof(word));
+        if (strcmp(word, "$timescale") == 0)
+        {
+            p = skipSpace(p, end);
+            dec->tick = vcdTimescale(p);
+        }
+        else if (strcmp(word, "$var") == 0)
+        {
+            p = token(p, end, word, sizeof(word));          // Type
+            p = token(p, end, width, sizeof(width));
+            p = token(p, end, code, sizeof(code));
+            p = token(p, end, name, sizeof(name));
+
+            for (i = 0; i < 4; i++)
+            {
+                if (!(found & (1u << i)) && strcmp(name, names[i]) == 0)
+                {
+                    signal = &vcdSignals[vcdCount++];
+                    strcpy(signal->code, code);
+                    signal->width = atoi(width);
+                    if (signal->width > MAX_DACS)
+                        signal->width = MAX_DACS;
+                    for (d = 0; d < signal->width; d++)
+                    {
+                        if (i == 0)         signal->masks[d] = dec->sclk;
+                        else if (i == 1)    signal->masks[d] = dec->ldac;
+                        else if (i == 2)    signal->masks[d] = dec->cs[d];
+                        else                signal->masks[d] = dec->sdi[d];
+                    }
+                    if (i == 2)
+                        dec->dacs = signal->width;
+                    found |= 1u << i;
+                }
+            }
+        }
+        else if (strcmp(word, "$enddefinitions") == 0)
+            break;
+    }
+
+    for (i = 0; i < 4; i++)
+    {
+        if (!(found & (1u << i)))
+        {
+            printf("VCD: no signal %s\n", names[i]);
+            return false;
+        }
+    }
+
+    // CS_ idles high
+    for (d = 0; d < dec->dacs; d++)
+        pins |= dec->cs[d];
+    dec->last = pins | dec->ldac;
+
+    // Value changes, handled once per time step
+    while (p < end)
+    {
+        p = skipSpace(p, end);
+        if (p >= end)
+            break;
+
+        const char *line = p;
+        while (p < end && *p != '\n')
+            p++;
+        const char *eol = p;
+        while (eol > line && isSpace(eol[-1]))
+            eol--;
+
+        if (*line == '#')
+        {
+            if (changed && pins != dec->last)
+                spiChange(dec, time, pins);
+            changed = false;
+            time = strtoull(line + 1, NULL, 10);
+        }
+        else if (*line == '0' || *line == '1' || *line == 'x' || *line == 'z' || *line == 'X' || *line == 'Z')
+        {
+            signal = vcdFind(line + 1, eol - line - 1);
+            if (signal != NULL)
+            {
+                pins = (*line == '1') ? (pins | signal->masks[0]) : (pins & ~signal->masks[0]);
+                changed = true;
+            }
+        }
+        else if (*line == 'b' || *line == 'B')
+        {
+            const char *bits = line + 1, *space = bits;
+            while (space < eol && !isSpace(*space))
+                space++;
+            signal = vcdFind(skipSpace(space, eol), eol - skipSpace(space, eol));
+            if (signal != NULL)
+            {
+                // MSB first, shorter values are zero extended
+                for (d = 0; d < signal->width; d++)
+                {
+                    const char *bit = space - 1 - d;
+                    bool one = (bit >= bits) && (*bit == '1');
+                    pins = one ? (pins | signal->masks[d]) : (pins & ~signal->masks[d]);
+                }
+                changed = true;
+            }
+        }
+    }
+    if (changed && pins != dec->last)
+        spiChange(dec, time, pins);
+    return true;
+}
+
+// "name=value,..." options
+static bool parsePins(SpiDecoder *dec, const char *text)
+{
+    char name[16];
+    unsigned int bit, d;
+    int used;
+
+    while (sscanf(text, "%15[a-z0-9]=%u%n", name, &bit, &used) == 2)
+    {
+        if (bit >= 32)
+            return false;
+        if (strcmp(name, "sclk") == 0)
+            dec->sclk = 1u << bit;
+        else if (strcmp(name, "ldac") == 0)
+            dec->ldac = 1u << bit;
+        else if (sscanf(name, "cs%u", &d) == 1 && d < MAX_DACS)
+            dec->cs[d] = 1u << bit;
+        else if (sscanf(name, "sdi%u", &d) == 1 && d < MAX_DACS)
+            dec->sdi[d] = 1u << bit;
+        else
+            return false;
+
+        text += used;
+        if (*text != ',')
+            break;
+        text++;
+    }
+    return *text == '\0';
+}
+
+static bool parseNames(char names[4][NAME_LENGTH], const char *text)
+{
+    static const char *const pins[4] = { "sclk", "ldac", "cs", "sdi" };
+    char pin[16], name[NAME_LENGTH];
+    unsigned int i;
+    int used;
+
+    while (sscanf(text, "%15[a-z]=%63[^,]%n", pin, name, &used) == 2)
+    {
+        for (i = 0; i < 4 && strcmp(pin, pins[i]) != 0; i++)
+            ;
+        if (i == 4)
+            return false;
+        strcpy(names[i], name);
+
+        text += used;
+        if (*text != ',')
+            break;
+        text++;
+    }
+    return *text == '\0';
+}
+
+//-----------------------------------------------------------------------------
+// Main
+//-----------------------------------------------------------------------------
+
+int main(int argc, char* argv[])
+{
+    char names[4][NAME_LENGTH] = { "CLK_SPI", "LDAC_", "CS_", "SDI" };
+    double rate = 0;
+    uint32_t unit = 1, d;
+    const char *outPath = NULL;
+    bool customPins = false, vcd;
+    struct timespec start, end;
+    struct stat info;
+    void *data;
+    int option, file;
+
+    memset(&spi, 0, sizeof(spi));
+    spi.minPeriod = 1e30;
+
+    while ((option = getopt(argc, argv, "r:u:p:n:o:")) != -1)
+    {
+        switch (option)
+        {
+            case 'r':
+                rate = strtod(optarg, NULL);
+                break;
+            case 'u':
+                unit = atoi(optarg);
+                break;
+            case 'p':
+                if (!parsePins(&spi, optarg))
+                {
+                    printf("-p %s: expected sclk=n,ldac=n,cs0=n,sdi0=n,...\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                customPins = true;
+                break;
+            case 'n':
+                if (!parseNames(names, optarg))
+                {
+                    printf("-n %s: expected sclk=name,ldac=name,cs=name,sdi=name\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'o':
+                outPath = optarg;
+                break;
+            default:
+                return EXIT_FAILURE;
+        }
+    }
+
+    if (optind != argc - 1 || (unit != 1 && unit != 2 && unit != 4))
+    {
+        printf("usage: %s [-r rate] [-u 1|2|4] [-p pin=n,...] [-n pin=name,...] [-o file] capture\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    file = open(argv[optind], O_RDONLY);
+    if (file < 0 || fstat(file, &info) != 0 || info.st_size == 0)
+    {
+        printf("%s: cannot open\n", argv[optind]);
+        return EXIT_FAILURE;
+    }
+    data = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+    if (data == MAP_FAILED)
+    {
+        printf("%s: cannot map\n", argv[optind]);
+        return EXIT_FAILURE;
+    }
+    madvise(data, info.st_size, MADV_SEQUENTIAL);
+
+    if (outPath)
+    {
+        spi.out = fopen(outPath, "w");
+        if (spi.out == NULL)
+        {
+            printf("%s: cannot create\n", outPath);
+            return EXIT_FAILURE;
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    vcd = (info.st_size > 0 && ((const char *)data)[0] == '$');
+    if (vcd)
+    {
+        // One pin per bit: sclk, ldac, then cs and sdi of each DAC
+        spi.sclk = 1u << 0;
+        spi.ldac = 1u << 1;
+        for (d = 0; d < MAX_DACS; d++)
+        {
+            spi.cs[d] = 1u << (2 + 2 * d);
+            spi.sdi[d] = 1u << (3 + 2 * d);
+        }
+        if (!decodeVcd(&spi, data, info.st_size, names))
+            return EXIT_FAILURE;
+    }
+    else
+    {
+        if (rate <= 0)
+        {
+            printf("%s: binary capture, -r sample rate needed\n", argv[optind]);
+            return EXIT_FAILURE;
+        }
+        if (!customPins)
+            parsePins(&spi, "sclk=1,ldac=3,cs0=0,sdi0=2");
+        for (spi.dacs = 0; spi.dacs < MAX_DACS && spi.cs[spi.dacs] != 0; spi.dacs++)
+            ;
+        spi.tick = 1.0 / rate;
+        decodeBinary(&spi, data, info.st_size, unit);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double wall = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) * 1e-9;
+
+    printf("%s: %.1f MB in %.3f s (%.0f MB/s), %u DACs\n", argv[optind], info.st_size * 1e-6, wall,
+           info.st_size * 1e-6 / wall, spi.dacs);
+    printf("%llu frames, %llu bad, %llu samples\n", (unsigned long long)spi.frames,
+           (unsigned long long)spi.badFrames, (unsigned long long)spi.samples);
+
+    if (spi.samples > 1)
+    {
+        double n = spi.samples - 1;
+        double mean = spi.sum / n;
+        double deviation = sqrt(spi.sumSquares / n - mean * mean);
+
+        printf("sample rate %.3f Hz, period %.3f us (min %.3f, max %.3f), jitter %.3f ns rms, %.3f ns peak to peak\n",
+               1.0 / mean, mean * 1e6, spi.minPeriod * 1e6, spi.maxPeriod * 1e6,
+               deviation * 1e9, (spi.maxPeriod - spi.minPeriod) * 1e9);
+    }
+
+    if (spi.out)
+        fclose(spi.out);
+    munmap(data, info.st_size);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,156 @@
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: any Linux host (no hardware required)
+
+// Stress harness for the shared register access in wavegen_shadow.h
+//   Every field of channels 0 to 2 is owned by its own writer threads which
+//   hammer it through modifyRegister() against an in-memory register file.
+//   Before each write a thread checks that its field still holds the value
+//   it last wrote, so any lost read-modify-write update is reported.
+//
+// Build:
+//   gcc -O2 -pthread -o wavegen_stress wavegen_stress.c
+// Run:
+//   ./wavegen_stress [iterations per thread]
+//-----------------------------------------------------------------------------
+
+#include <stdlib.h>             // EXIT_ codes, atoi
+#include <stdio.h>              // printf
+#include <stdint.h>             // C99 integer types -- uint32_t
+#include <pthread.h>            // pthread_create, pthread_join
+#include "wavegen_shadow.h"     // shadow registers and device lock
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+typedef struct
+{
+    const char *name;
+    unsigned int offset;        // Register holding the field
+    uint32_t mask;              // Field bits within the register
+} StressField;
+
+// Every field of channels 0 to 2, as packed by the driver: the run mask and
+// the control registers are shared between fields, the rest are whole words
+static const StressField fields[] =
+{
+    { "mode 0",         OFS_CH(0, OFS_CH_CTRL),         CH_CTRL_MODE },
+    { "mode 1",         OFS_CH(1, OFS_CH_CTRL),         CH_CTRL_MODE },
+    { "mode 2",         OFS_CH(2, OFS_CH_CTRL),         CH_CTRL_MODE },
+    { "hilbert 0",      OFS_CH(0, OFS_CH_CTRL),         CH_CTRL_HILBERT },
+    { "hilbert 1",      OFS_CH(1, OFS_CH_CTRL),         CH_CTRL_HILBERT },
+    { "hilbert 2",      OFS_CH(2, OFS_CH_CTRL),         CH_CTRL_HILBERT },
+    { "complement 0",   OFS_CH(0, OFS_CH_CTRL),         CH_CTRL_COMPLEMENT },
+    { "complement 1",   OFS_CH(1, OFS_CH_CTRL),         CH_CTRL_COMPLEMENT },
+    { "complement 2",   OFS_CH(2, OFS_CH_CTRL),         CH_CTRL_COMPLEMENT },
+    { "run 0",          OFS_RUN_MASK,                   0x00000001 },
+    { "run 1",          OFS_RUN_MASK,                   0x00000002 },
+    { "run 2",          OFS_RUN_MASK,                   0x00000004 },
+    { "frequency 0",    OFS_CH(0, OFS_CH_FREQ),         0xFFFFFFFF },
+    { "frequency 1",    OFS_CH(1, OFS_CH_FREQ),         0xFFFFFFFF },
+    { "offset 0",       OFS_CH(0, OFS_CH_OFFSET),       0x0000FFFF },
+    { "offset 1",       OFS_CH(1, OFS_CH_OFFSET),       0x0000FFFF },
+    { "amplitude 0",    OFS_CH(0, OFS_CH_AMPLITUDE),    0x0000FFFF },
+    { "amplitude 1",    OFS_CH(1, OFS_CH_AMPLITUDE),    0x0000FFFF },
+    { "duty 0",         OFS_CH(0, OFS_CH_DTYCYC),       0x0000FFFF },
+    { "duty 1",         OFS_CH(1, OFS_CH_DTYCYC),       0x0000FFFF },
+    { "cycles 0",       OFS_CH(0, OFS_CH_CYCLES),       0x0000FFFF },
+    { "cycles 1",       OFS_CH(1, OFS_CH_CYCLES),       0x0000FFFF },
+    { "phase 0",        OFS_CH(0, OFS_CH_PHASE),        0x0000FFFF },
+    { "phase 1",        OFS_CH(1, OFS_CH_PHASE),        0x0000FFFF },
+    { "sample rate",    OFS_SRATE,                      0xFFFFFFFF },
+};
+
+#define FIELD_COUNT (sizeof(fields) / sizeof(fields[0]))
+
+typedef struct
+{
+    const StressField *field;
+    unsigned int seed;
+    uint32_t last;              // Last value written to the field
+    unsigned long errors;       // Times the field was found overwritten
+} StressWriter;
+
+static uint32_t registers[IP_SPAN_IN_BYTES / 4];  // In-memory stand-in for the IP
+static struct wavegen_device device;
+static unsigned long iterations = 1000000;
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+void *writerThread(void *arg)
+{
+    StressWriter *writer = arg;
+    const StressField *field = writer->field;
+    unsigned long i;
+    uint32_t value;
+
+    for (i = 0; i < iterations; i++)
+    {
+        if ((readRegister(&device, field->offset) & field->mask) != writer->last)
+            writer->errors++;
+
+        value = (uint32_t)rand_r(&writer->seed) * 2654435761u;
+        value &= field->mask;
+
+        modifyRegister(&device, field->offset, field->mask, value);
+        writer->last = value;
+    }
+
+    return NULL;
+}
+
+int main(int argc, char *argv[])
+{
+    pthread_t threads[FIELD_COUNT];
+    StressWriter writers[FIELD_COUNT] = {0};
+    unsigned long errors = 0;
+    unsigned int i;
+
+    if (argc > 1)
+        iterations = strtoul(argv[1], NULL, 0);
+
+    device.bus = &wavegenMemoryBus;
+    device.base = registers;
+    loadShadow(&device);
+
+    for (i = 0; i < FIELD_COUNT; i++)
+    {
+        writers[i].field = &fields[i];
+        writers[i].seed = i + 1;
+        pthread_create(&threads[i], NULL, writerThread, &writers[i]);
+    }
+
+    for (i = 0; i < FIELD_COUNT; i++)
+        pthread_join(threads[i], NULL);
+
+    for (i = 0; i < FIELD_COUNT; i++)
+    {
+        const StressField *field = writers[i].field;
+
+        if ((registers[field->offset] & field->mask) != writers[i].last)
+            writers[i].errors++;
+
+        if (writers[i].errors)
+            printf("%-14s %lu lost updates\n", field->name, writers[i].errors);
+
+        errors += writers[i].errors;
+    }
+
+    for (i = 0; i < SHADOW_COUNT; i++)
+    {
+        if (registers[shadowOffset(i)] != device.shadow[i])
+        {
+            printf("register offset: %d bus %08x shadow %08x\n", shadowOffset(i), registers[shadowOffset(i)], device.shadow[i]);
+            errors++;
+        }
+    }
+
+    printf("%u threads x %lu writes: %s\n", (unsigned int)FIELD_COUNT, iterations, errors ? "FAILED" : "passed");
+
+    return errors ? EXIT_FAILURE : EXIT_SUCCESS;
+}
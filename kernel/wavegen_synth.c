@@ -0,0 +1,653 @@
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: Xilinx XUP Blackboard (Cortex-A9, NEON) or any host (SSE2, C)
+
+// Waveform synthesis:
+//   Every shape is made as floats of full scale 1 in blocks of SYNTH_BLOCK,
+//   rounded to Q14, then calibrated with the integer steps of
+//   version_2/samplePipeline.sv. The sine is a degree 11 polynomial on the
+//   folded phase (error below 1e-7, Q14 is 6e-5). Expressions run as a
+//   postfix program over a whole block at a time, one pass per operator.
+
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>         // C99 integer types -- uint32_t
+#include <stdbool.h>        // bool
+#include <stdlib.h>         // strtod
+#include <string.h>         // memset, strncmp
+#include <ctype.h>          // isspace, isalpha
+#include <math.h>           // sin, floor
+#include "wavegen_synth.h"  // synthesis state
+
+#if !defined(WAVEGEN_SYNTH_SCALAR) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#include <arm_neon.h>       // NEON intrinsics
+#define SYNTH_NEON
+#elif !defined(WAVEGEN_SYNTH_SCALAR) && defined(__SSE2__)
+#include <emmintrin.h>      // SSE2 intrinsics
+#define SYNTH_SSE2
+#endif
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+#define PI 3.14159265358979323846
+#define DEFAULT_FP_SCALE 14         // Q14 gain
+#define CALIBRATION_SCALE 11        // Calibration slope, 2048 = 1
+#define Q14_MIN -16384.0f
+#define Q14_MAX 16383.0f
+#define ROUND_BIAS 32768            // Keeps the rounding on positive numbers
+#define SWEEP_BITS 16               // Fraction bits of the chirp deltaPhase
+
+// Folded phase (int32, 2^31 = pi) to radians, and the sine series
+#define PHASE_RADIANS ((float)(PI / 2147483648.0))
+#define SIN_C3  (-1.0f / 6)
+#define SIN_C5  (1.0f / 120)
+#define SIN_C7  (-1.0f / 5040)
+#define SIN_C9  (1.0f / 362880)
+#define SIN_C11 (-1.0f / 39916800)
+
+enum
+{
+    OP_NUMBER, OP_T, OP_N,
+    OP_ADD, OP_SUB, OP_MUL, OP_DIV, OP_POW, OP_NEG,
+    OP_SIN, OP_COS, OP_SQRT, OP_ABS, OP_EXP, OP_LOG, OP_FLOOR
+};
+
+static const struct
+{
+    const char *name;
+    uint8_t op;
+} functions[] =
+{
+    { "sin", OP_SIN }, { "cos", OP_COS }, { "sqrt", OP_SQRT }, { "abs", OP_ABS },
+    { "exp", OP_EXP }, { "log", OP_LOG }, { "floor", OP_FLOOR }
+};
+
+typedef struct
+{
+    const char *next;
+    SynthChannel *synth;
+    uint32_t depth;
+    bool ok;
+} Parser;
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+// Kernels: phase to sine, floats to Q14, Q14 to DAC words
+
+static inline float sineScalar(uint32_t phase)
+{
+    // Quadrants 1 and 2 fold onto 0 and 3: pi - x
+    uint32_t fold = (uint32_t)((int32_t)(phase + 0x40000000u) >> 31);
+    int32_t folded = (int32_t)((phase & ~fold) | ((0x80000000u - phase) & fold));
+    float x = (float)folded * PHASE_RADIANS;
+    float x2 = x * x;
+
+    return x * (1.0f + x2 * (SIN_C3 + x2 * (SIN_C5 + x2 * (SIN_C7 + x2 * (SIN_C9 + x2 * SIN_C11)))));
+}
+
+static void sineKernel(const uint32_t *phase, float *out, uint32_t count)
+{
+    uint32_t i = 0;
+
+#if defined(SYNTH_NEON)
+    const uint32x4_t quarter = vdupq_n_u32(0x40000000u), half = vdupq_n_u32(0x80000000u);
+    const float32x4_t scale = vdupq_n_f32(PHASE_RADIANS), one = vdupq_n_f32(1.0f);
+    const float32x4_t c3 = vdupq_n_f32(SIN_C3), c5 = vdupq_n_f32(SIN_C5), c7 = vdupq_n_f32(SIN_C7);
+    const float32x4_t c9 = vdupq_n_f32(SIN_C9), c11 = vdupq_n_f32(SIN_C11);
+
+    for (; i + 4 <= count; i += 4)
+    {
+        uint32x4_t p = vld1q_u32(phase + i);
+        uint32x4_t fold = vreinterpretq_u32_s32(vshrq_n_s32(vreinterpretq_s32_u32(vaddq_u32(p, quarter)), 31));
+        uint32x4_t folded = vbslq_u32(fold, vsubq_u32(half, p), p);
+        float32x4_t x = vmulq_f32(vcvtq_f32_s32(vreinterpretq_s32_u32(folded)), scale);
+        float32x4_t x2 = vmulq_f32(x, x);
+        float32x4_t y = vaddq_f32(c9, vmulq_f32(x2, c11));
+        y = vaddq_f32(c7, vmulq_f32(x2, y));
+        y = vaddq_f32(c5, vmulq_f32(x2, y));
+        y = vaddq_f32(c3, vmulq_f32(x2, y));
+        y = vaddq_f32(one, vmulq_f32(x2, y));
+        vst1q_f32(out + i, vmulq_f32(x, y));
+    }
+#elif defined(SYNTH_SSE2)
+    const __m128i quarter = _mm_set1_epi32(0x40000000), half = _mm_set1_epi32((int32_t)0x80000000u);
+    const __m128 scale = _mm_set1_ps(PHASE_RADIANS), one = _mm_set1_ps(1.0f);
+    const __m128 c3 = _mm_set1_ps(SIN_C3), c5 = _mm_set1_ps(SIN_C5), c7 = _mm_set1_ps(SIN_C7);
+    const __m128 c9 = _mm_set1_ps(SIN_C9), c11 = _mm_set1_ps(SIN_C11);
+
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i p = _mm_loadu_si128((const __m128i *)(phase + i));
+        __m128i fold = _mm_srai_epi32(_mm_add_epi32(p, quarter), 31);
+        __m128i folded = _mm_or_si128(_mm_andnot_si128(fold, p), _mm_and_si128(fold, _mm_sub_epi32(half, p)));
+        __m128 x = _mm_mul_ps(_mm_cvtepi32_ps(folded), scale);
+        __m128 x2 = _mm_mul_ps(x, x);
+        __m128 y = _mm_add_ps(c9, _mm_mul_ps(x2, c11));
+        y = _mm_add_ps(c7, _mm_mul_ps(x2, y));
+        y = _mm_add_ps(c5, _mm_mul_ps(x2, y));
+        y = _mm_add_ps(c3, _mm_mul_ps(x2, y));
+        y = _mm_add_ps(one, _mm_mul_ps(x2, y));
+        _mm_storeu_ps(out + i, _mm_mul_ps(x, y));
+    }
+#endif
+
+    for (; i < count; i++)
+        out[i] = sineScalar(phase[i]);
+}
+
+// Round to nearest (ties up) and saturate to -16384..16383
+static void quantizeKernel(const float *in, int16_t *out, uint32_t count)
+{
+    uint32_t i = 0;
+
+#if defined(SYNTH_NEON)
+    const float32x4_t scale = vdupq_n_f32(1 << DEFAULT_FP_SCALE), lo = vdupq_n_f32(Q14_MIN), hi = vdupq_n_f32(Q14_MAX);
+    const float32x4_t bias = vdupq_n_f32(ROUND_BIAS + 0.5f);
+    const int32x4_t unbias = vdupq_n_s32(ROUND_BIAS);
+
+    for (; i + 8 <= count; i += 8)
+    {
+        float32x4_t a = vmaxq_f32(vminq_f32(vmulq_f32(vld1q_f32(in + i), scale), hi), lo);
+        float32x4_t b = vmaxq_f32(vminq_f32(vmulq_f32(vld1q_f32(in + i + 4), scale), hi), lo);
+        int32x4_t qa = vsubq_s32(vcvtq_s32_f32(vaddq_f32(a, bias)), unbias);
+        int32x4_t qb = vsubq_s32(vcvtq_s32_f32(vaddq_f32(b, bias)), unbias);
+        vst1q_s16(out + i, vcombine_s16(vmovn_s32(qa), vmovn_s32(qb)));
+    }
+#elif defined(SYNTH_SSE2)
+    const __m128 scale = _mm_set1_ps(1 << DEFAULT_FP_SCALE), lo = _mm_set1_ps(Q14_MIN), hi = _mm_set1_ps(Q14_MAX);
+    const __m128 bias = _mm_set1_ps(ROUND_BIAS + 0.5f);
+    const __m128i unbias = _mm_set1_epi32(ROUND_BIAS);
+
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128 a = _mm_max_ps(_mm_min_ps(_mm_mul_ps(_mm_loadu_ps(in + i), scale), hi), lo);
+        __m128 b = _mm_max_ps(_mm_min_ps(_mm_mul_ps(_mm_loadu_ps(in + i + 4), scale), hi), lo);
+        __m128i qa = _mm_sub_epi32(_mm_cvttps_epi32(_mm_add_ps(a, bias)), unbias);
+        __m128i qb = _mm_sub_epi32(_mm_cvttps_epi32(_mm_add_ps(b, bias)), unbias);
+        _mm_storeu_si128((__m128i *)(out + i), _mm_packs_epi32(qa, qb));
+    }
+#endif
+
+    for (; i < count; i++)
+    {
+        float v = in[i] * (1 << DEFAULT_FP_SCALE);
+        v = (v < Q14_MAX) ? v : Q14_MAX;
+        v = (v > Q14_MIN) ? v : Q14_MIN;
+        out[i] = (int16_t)((int32_t)(v + (ROUND_BIAS + 0.5f)) - ROUND_BIAS);
+    }
+}
+
+// samplePipeline from shape to dac_words. The low 12 bits of a >> 11 are
+// the same signed or unsigned, so the SIMD versions shift arithmetically.
+void synthCalibrate(const SynthChannel *synth, const int16_t *samples, uint16_t *words, uint32_t count)
+{
+    const int32_t offset = synth->offset;
+    const int32_t intercept = (synth->calIntercept & 0xFFF) + 2048;
+    uint32_t i = 0;
+
+#if defined(SYNTH_NEON)
+    const int16x4_t amplitude = vdup_n_s16(synth->amplitude), slope = vdup_n_s16(synth->calSlope);
+    const int32x4_t offsets = vdupq_n_s32(offset), intercepts = vdupq_n_s32(intercept), mask = vdupq_n_s32(0xFFF);
+
+    for (; i + 8 <= count; i += 8)
+    {
+        int16x8_t shape = vld1q_s16(samples + i);
+        int32x4_t a = vshrq_n_s32(vaddq_s32(vshrq_n_s32(vmull_s16(vget_low_s16(shape), amplitude), DEFAULT_FP_SCALE), offsets), 3);
+        int32x4_t b = vshrq_n_s32(vaddq_s32(vshrq_n_s32(vmull_s16(vget_high_s16(shape), amplitude), DEFAULT_FP_SCALE), offsets), 3);
+        a = vandq_s32(vaddq_s32(vshrq_n_s32(vmull_s16(vmovn_s32(a), slope), CALIBRATION_SCALE), intercepts), mask);
+        b = vandq_s32(vaddq_s32(vshrq_n_s32(vmull_s16(vmovn_s32(b), slope), CALIBRATION_SCALE), intercepts), mask);
+        vst1q_u16(words + i, vreinterpretq_u16_s16(vcombine_s16(vmovn_s32(a), vmovn_s32(b))));
+    }
+#elif defined(SYNTH_SSE2)
+    const __m128i amplitude = _mm_set1_epi16(synth->amplitude), slope = _mm_set1_epi16(synth->calSlope);
+    const __m128i offsets = _mm_set1_epi32(offset), intercepts = _mm_set1_epi32(intercept), mask = _mm_set1_epi32(0xFFF);
+
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i shape = _mm_loadu_si128((const __m128i *)(samples + i));
+        __m128i lo = _mm_mullo_epi16(shape, amplitude), hi = _mm_mulhi_epi16(shape, amplitude);
+        __m128i a = _mm_srai_epi32(_mm_add_epi32(_mm_srai_epi32(_mm_unpacklo_epi16(lo, hi), DEFAULT_FP_SCALE), offsets), 3);
+        __m128i b = _mm_srai_epi32(_mm_add_epi32(_mm_srai_epi32(_mm_unpackhi_epi16(lo, hi), DEFAULT_FP_SCALE), offsets), 3);
+        __m128i sampleSigned = _mm_packs_epi32(a, b);
+        lo = _mm_mullo_epi16(sampleSigned, slope);
+        hi = _mm_mulhi_epi16(sampleSigned, slope);
+        a = _mm_and_si128(_mm_add_epi32(_mm_srai_epi32(_mm_unpacklo_epi16(lo, hi), CALIBRATION_SCALE), intercepts), mask);
+        b = _mm_and_si128(_mm_add_epi32(_mm_srai_epi32(_mm_unpackhi_epi16(lo, hi), CALIBRATION_SCALE), intercepts), mask);
+        _mm_storeu_si128((__m128i *)(words + i), _mm_packs_epi32(a, b));
+    }
+#endif
+
+    for (; i < count; i++)
+    {
+        int32_t gained = (samples[i] * synth->amplitude) >> DEFAULT_FP_SCALE;
+        int16_t sampleSigned = (int16_t)((gained + offset) >> 3);
+        uint32_t sampleGained = (uint32_t)(sampleSigned * synth->calSlope) >> CALIBRATION_SCALE;
+        words[i] = (uint16_t)((sampleGained + intercept) & 0xFFF);
+    }
+}
+
+const char *synthKernels()
+{
+#if defined(SYNTH_NEON)
+    return "neon";
+#elif defined(SYNTH_SSE2)
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
+
+// Shapes
+
+static uint32_t deltaPhase(const SynthChannel *synth, double frequency)
+{
+    double delta = frequency / synth->rate * 4294967296.0;
+    return (uint32_t)(int64_t)llround(delta);
+}
+
+static void tonesBlock(SynthChannel *synth, float *out, uint32_t count)
+{
+    uint32_t phase[SYNTH_BLOCK];
+    float sine[SYNTH_BLOCK];
+    uint32_t t, i;
+
+    memset(out, 0, count * sizeof(float));
+    for (t = 0; t < synth->tones; t++)
+    {
+        uint32_t p = synth->phase[t], delta = synth->deltaPhase[t];
+        float level = synth->level[t];
+
+        for (i = 0; i < count; i++)
+            phase[i] = p + i * delta;
+        synth->phase[t] = p + count * delta;
+
+        sineKernel(phase, sine, count);
+        for (i = 0; i < count; i++)
+            out[i] += level * sine[i];
+    }
+}
+
+static void chirpBlock(SynthChannel *synth, float *out, uint32_t count)
+{
+    uint32_t phase[SYNTH_BLOCK];
+    uint32_t i;
+
+    for (i = 0; i < count; i++)
+    {
+        phase[i] = synth->phase[0];
+        synth->phase[0] += (uint32_t)(synth->sweepDelta >> SWEEP_BITS);
+        synth->sweepDelta += (uint64_t)synth->sweep;
+        if (++synth->sweepCount == synth->sweepSamples)
+        {
+            synth->sweepDelta = synth->sweepStart;
+            synth->sweepCount = 0;
+        }
+    }
+    sineKernel(phase, out, count);
+}
+
+static inline float noiseLane(uint32_t *state)
+{
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return (float)(int32_t)x * (1.0f / 2147483648.0f);
+}
+
+// Sample k comes from lane k % 4, whatever the block lengths
+static void noiseBlock(SynthChannel *synth, float *out, uint32_t count)
+{
+    uint32_t i = 0, lane;
+
+    for (; i < count && ((synth->index + i) & 3); i++)
+        out[i] = noiseLane(&synth->noise[(synth->index + i) & 3]);
+    for (; i + 4 <= count; i += 4)
+    {
+        for (lane = 0; lane < 4; lane++)
+            out[i + lane] = noiseLane(&synth->noise[lane]);
+    }
+    for (; i < count; i++)
+        out[i] = noiseLane(&synth->noise[(synth->index + i) & 3]);
+}
+
+static void expressionBlock(SynthChannel *synth, float *out, uint32_t count)
+{
+    double stack[SYNTH_STACK][SYNTH_BLOCK];
+    uint32_t top = 0, k, i;
+
+    for (k = 0; k < synth->length; k++)
+    {
+        const SynthOp *op = &synth->program[k];
+        double *x = stack[(top > 0) ? top - 1 : 0], *y = stack[top];
+
+        switch (op->op)
+        {
+            case OP_NUMBER: for (i = 0; i < count; i++) y[i] = op->value;                         top++; break;
+            case OP_T:      for (i = 0; i < count; i++) y[i] = (double)(synth->index + i) / synth->rate; top++; break;
+            case OP_N:      for (i = 0; i < count; i++) y[i] = (double)(synth->index + i);        top++; break;
+            case OP_ADD:    for (i = 0; i < count; i++) stack[top - 2][i] += x[i];                top--; break;
+            case OP_SUB:    for (i = 0; i < count; i++) stack[top - 2][i] -= x[i];                top--; break;
+            case OP_MUL:    for (i = 0; i < count; i++) stack[top - 2][i] *= x[i];                top--; break;
+            case OP_DIV:    for (i = 0; i < count; i++) stack[top - 2][i] /= x[i];                top--; break;
+            case OP_POW:    for (i = 0; i < count; i++) stack[top - 2][i] = pow(stack[top - 2][i], x[i]); top--; break;
+            case OP_NEG:    for (i = 0; i < count; i++) x[i] = -x[i];                             break;
+            case OP_SIN:    for (i = 0; i < count; i++) x[i] = sin(x[i]);                         break;
+            case OP_COS:    for (i = 0; i < count; i++) x[i] = cos(x[i]);                         break;
+            case OP_SQRT:   for (i = 0; i < count; i++) x[i] = sqrt(x[i]);                        break;
+            case OP_ABS:    for (i = 0; i < count; i++) x[i] = fabs(x[i]);                        break;
+            case OP_EXP:    for (i = 0; i < count; i++) x[i] = exp(x[i]);                         break;
+            case OP_LOG:    for (i = 0; i < count; i++) x[i] = log(x[i]);                         break;
+            case OP_FLOOR:  for (i = 0; i < count; i++) x[i] = floor(x[i]);                       break;
+        }
+    }
+
+    // NaN (log of a negative, 0/0) plays as 0
+    for (i = 0; i < count; i++)
+        out[i] = (stack[0][i] == stack[0][i]) ? (float)stack[0][i] : 0.0f;
+}
+
+// Expression parser: + - * / ^, unary -, t (seconds), n (sample), pi,
+// numbers and functions[], compiled to postfix
+
+static void emit(Parser *parser, uint8_t op, double value)
+{
+    SynthChannel *synth = parser->synth;
+
+    if (op <= OP_N)
+        parser->depth++;
+    else if (op < OP_NEG)
+        parser->depth--;
+
+    if (synth->length == SYNTH_PROGRAM || parser->depth > SYNTH_STACK)
+    {
+        parser->ok = false;
+        return;
+    }
+    synth->program[synth->length].op = op;
+    synth->program[synth->length].value = value;
+    synth->length++;
+}
+
+static bool accept(Parser *parser, char c)
+{
+    while (isspace((unsigned char)*parser->next))
+        parser->next++;
+    if (*parser->next != c)
+        return false;
+    parser->next++;
+    return true;
+}
+
+static void parseSum(Parser *parser);
+static void parseUnary(Parser *parser);
+
+static void parsePrimary(Parser *parser)
+{
+    const char *start;
+    size_t length, f;
+    char *end;
+
+    while (isspace((unsigned char)*parser->next))
+        parser->next++;
+    start = parser->next;
+
+    if (accept(parser, '('))
+    {
+        parseSum(parser);
+        parser->ok &= accept(parser, ')');
+        return;
+    }
+    if (isdigit((unsigned char)*start) || *start == '.')
+    {
+        emit(parser, OP_NUMBER, strtod(start, &end));
+        parser->next = end;
+        return;
+    }
+
+    while (isalpha((unsigned char)*parser->next))
+        parser->next++;
+    length = parser->next - start;
+
+    if (length == 1 && *start == 't')
+        emit(parser, OP_T, 0);
+    else if (length == 1 && *start == 'n')
+        emit(parser, OP_N, 0);
+    else if (length == 2 && strncmp(start, "pi", 2) == 0)
+        emit(parser, OP_NUMBER, PI);
+    else
+    {
+        for (f = 0; f < sizeof(functions) / sizeof(functions[0]); f++)
+        {
+            if (length == strlen(functions[f].name) && strncmp(start, functions[f].name, length) == 0)
+                break;
+        }
+        if (length == 0 || f == sizeof(functions) / sizeof(functions[0]) || !accept(parser, '('))
+        {
+            parser->ok = false;
+            return;
+        }
+        parseSum(parser);
+        parser->ok &= accept(parser, ')');
+        emit(parser, functions[f].op, 0);
+    }
+}
+
+static void parsePower(Parser *parser)
+{
+    parsePrimary(parser);
+    if (parser->ok && accept(parser, '^'))
+    {
+        parseUnary(parser);
+        emit(parser, OP_POW, 0);
+    }
+}
+
+static void parseUnary(Parser *parser)
+{
+    if (accept(parser, '-'))
+    {
+        parseUnary(parser);
+        emit(parser, OP_NEG, 0);
+    }
+    else
+        parsePower(parser);
+}
+
+static void parseProduct(Parser *parser)
+{
+    parseUnary(parser);
+    while (parser->ok)
+    {
+        if (accept(parser, '*'))
+        {
+            parseUnary(parser);
+            emit(parser, OP_MUL, 0);
+        }
+        else if (accept(parser, '/'))
+        {
+            parseUnary(parser);
+            emit(parser, OP_DIV, 0);
+        }
+        else
+            break;
+    }
+}
+
+static void parseSum(Parser *parser)
+{
+    parseProduct(parser);
+    while (parser->ok)
+    {
+        if (accept(parser, '+'))
+        {
+            parseProduct(parser);
+            emit(parser, OP_ADD, 0);
+        }
+        else if (accept(parser, '-'))
+        {
+            parseProduct(parser);
+            emit(parser, OP_SUB, 0);
+        }
+        else
+            break;
+    }
+}
+
+// Channel setup
+
+// Calibration and gain of wavegen_system_top after power up
+void synthInit(SynthChannel *synth, uint32_t channel, uint32_t rate)
+{
+    memset(synth, 0, sizeof(*synth));
+    synth->rate = rate;
+    synth->amplitude = 16383;
+    synth->calSlope = (channel == 0) ? 1961 : (channel == 1) ? 1947 : 2048;
+    synth->calIntercept = (channel == 0) ? 24 : (channel == 1) ? 33 : 0;
+    synthSine(synth, 1000);
+}
+
+void synthSetGain(SynthChannel *synth, int16_t amplitude, int16_t offset)
+{
+    synth->amplitude = amplitude;
+    synth->offset = offset;
+}
+
+void synthSetCalibration(SynthChannel *synth, int16_t slope, uint16_t intercept)
+{
+    synth->calSlope = slope;
+    synth->calIntercept = intercept;
+}
+
+void synthSine(SynthChannel *synth, double frequency)
+{
+    synth->shape = SYNTH_SINE;
+    synth->tones = 0;
+    synthTone(synth, frequency, 1.0f);
+}
+
+// Adds a tone to the sine, levels add up and saturate past full scale
+bool synthTone(SynthChannel *synth, double frequency, float level)
+{
+    if (synth->shape != SYNTH_SINE || synth->tones == SYNTH_TONES)
+        return false;
+    synth->phase[synth->tones] = 0;
+    synth->deltaPhase[synth->tones] = deltaPhase(synth, frequency);
+    synth->level[synth->tones] = level;
+    synth->tones++;
+    return true;
+}
+
+// Linear sweep from start to stop Hz, repeated every seconds, phase continuous
+void synthChirp(SynthChannel *synth, double start, double stop, double seconds)
+{
+    uint32_t samples = (uint32_t)(seconds * synth->rate);
+
+    synth->shape = SYNTH_CHIRP;
+    synth->phase[0] = 0;
+    synth->sweepSamples = (samples > 0) ? samples : 1;
+    synth->sweepCount = 0;
+    synth->sweepStart = (uint64_t)deltaPhase(synth, start) << SWEEP_BITS;
+    synth->sweepDelta = synth->sweepStart;
+    synth->sweep = (int64_t)(((double)deltaPhase(synth, stop) - deltaPhase(synth, start)) * (1 << SWEEP_BITS) / synth->sweepSamples);
+}
+
+// Uniform white noise of full scale 1
+void synthNoise(SynthChannel *synth, uint32_t seed)
+{
+    uint32_t lane;
+
+    synth->shape = SYNTH_NOISE;
+    for (lane = 0; lane < 4; lane++)
+    {
+        // splitmix32, never a zero state
+        uint32_t z = seed + (lane + 1) * 0x9E3779B9u;
+        z = (z ^ (z >> 16)) * 0x85EBCA6Bu;
+        z = (z ^ (z >> 13)) * 0xC2B2AE35u;
+        z ^= z >> 16;
+        synth->noise[lane] = z ? z : 1;
+    }
+}
+
+// e.g. "0.5*sin(2*pi*1000*t) + 0.25*sin(2*pi*3000*t)", full scale 1
+bool synthExpression(SynthChannel *synth, const char *expression)
+{
+    Parser parser = { expression, synth, 0, true };
+
+    synth->length = 0;
+    parseSum(&parser);
+    while (isspace((unsigned char)*parser.next))
+        parser.next++;
+    parser.ok &= (*parser.next == '\0') && parser.depth == 1;
+    if (!parser.ok)
+    {
+        synth->length = 0;
+        return false;
+    }
+    synth->shape = SYNTH_EXPRESSION;
+    return true;
+}
+
+// Block API
+
+void synthQ14(SynthChannel *synth, int16_t *samples, uint32_t count)
+{
+    float block[SYNTH_BLOCK];
+    uint32_t n;
+
+    while (count > 0)
+    {
+        n = (count < SYNTH_BLOCK) ? count : SYNTH_BLOCK;
+        switch (synth->shape)
+        {
+            case SYNTH_SINE:        tonesBlock(synth, block, n);        break;
+            case SYNTH_CHIRP:       chirpBlock(synth, block, n);        break;
+            case SYNTH_NOISE:       noiseBlock(synth, block, n);        break;
+            case SYNTH_EXPRESSION:  expressionBlock(synth, block, n);   break;
+        }
+        quantizeKernel(block, samples, n);
+        synth->index += n;
+        samples += n;
+        count -= n;
+    }
+}
+
+void synthWords(SynthChannel *synth, uint16_t *words, uint32_t count)
+{
+    int16_t block[SYNTH_BLOCK];
+    uint32_t n;
+
+    while (count > 0)
+    {
+        n = (count < SYNTH_BLOCK) ? count : SYNTH_BLOCK;
+        synthQ14(synth, block, n);
+        synthCalibrate(synth, block, words, n);
+        words += n;
+        count -= n;
+    }
+}
+
+// Sample stream FIFO words: DAC A in bits 11:0, DAC B in 27:16
+void synthStreamWords(SynthChannel *a, SynthChannel *b, uint32_t *words, uint32_t count)
+{
+    uint16_t wordsA[SYNTH_BLOCK], wordsB[SYNTH_BLOCK];
+    uint32_t n, i;
+
+    while (count > 0)
+    {
+        n = (count < SYNTH_BLOCK) ? count : SYNTH_BLOCK;
+        synthWords(a, wordsA, n);
+        synthWords(b, wordsB, n);
+        for (i = 0; i < n; i++)
+            words[i] = wordsA[i] | ((uint32_t)wordsB[i] << 16);
+        words += n;
+        count -= n;
+    }
+}
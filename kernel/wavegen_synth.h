@@ -0,0 +1,93 @@
+// WAVEGEN waveform synthesis
+// Host side Q14 samples and calibrated DAC words for arb tables and streaming
+
+//-----------------------------------------------------------------------------
+// Synthesis:
+//   A SynthChannel makes one waveform in blocks of any length: a sine or a
+//   sum of tones, a linear chirp, white noise or an expression of t. The
+//   phase accumulators are 32 bit like stepCalc, so frequencies match the
+//   IP. synthQ14() gives the Q14 samples for setArbSamples(); synthWords()
+//   applies amplitude, offset and calibration exactly like samplePipeline
+//   (gain >>> 14, offset >>> 3, slope >> 11 plus intercept) and gives the
+//   12 bit DAC words for mode "stream". The per sample loops have NEON and
+//   SSE2 versions, picked at compile time (-mfpu=neon on the Cortex-A9);
+//   -DWAVEGEN_SYNTH_SCALAR builds the plain C ones.
+//-----------------------------------------------------------------------------
+
+#ifndef WAVEGEN_SYNTH_H
+#define WAVEGEN_SYNTH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SYNTH_BLOCK 256             // Samples per internal pass
+#define SYNTH_TONES 8               // Tones of a multitone
+#define SYNTH_PROGRAM 64            // Instructions of an expression
+#define SYNTH_STACK 8               // Expression nesting
+
+typedef enum
+{
+    SYNTH_SINE,                     // synthSine(), then synthTone() for more tones
+    SYNTH_CHIRP,
+    SYNTH_NOISE,
+    SYNTH_EXPRESSION
+} SynthShape;
+
+typedef struct
+{
+    uint8_t op;
+    double value;
+} SynthOp;
+
+typedef struct
+{
+    SynthShape shape;
+    uint32_t rate;                  // Samples per second
+    int16_t amplitude;              // Q14, as the channel register
+    int16_t offset;                 // Q14, as the channel register
+    int16_t calSlope;               // Gain 2048 = 1
+    uint16_t calIntercept;          // DAC codes, 12 bits
+    uint64_t index;                 // Samples made so far
+
+    // Sine and multitone, the chirp uses tone 0
+    uint32_t tones;
+    uint32_t phase[SYNTH_TONES];    // 2^32 = 360 degrees
+    uint32_t deltaPhase[SYNTH_TONES];
+    float level[SYNTH_TONES];       // Full scale 1
+
+    // Chirp: deltaPhase << 16 moves by sweep per sample for sweepSamples
+    uint64_t sweepDelta;
+    uint64_t sweepStart;
+    int64_t sweep;
+    uint32_t sweepSamples;
+    uint32_t sweepCount;
+
+    uint32_t noise[4];              // xorshift32 lanes
+
+    uint32_t length;
+    SynthOp program[SYNTH_PROGRAM]; // Expression, postfix
+} SynthChannel;
+
+void synthInit(SynthChannel *synth, uint32_t channel, uint32_t rate);
+void synthSetGain(SynthChannel *synth, int16_t amplitude, int16_t offset);
+void synthSetCalibration(SynthChannel *synth, int16_t slope, uint16_t intercept);
+void synthSine(SynthChannel *synth, double frequency);
+bool synthTone(SynthChannel *synth, double frequency, float level);
+void synthChirp(SynthChannel *synth, double start, double stop, double seconds);
+void synthNoise(SynthChannel *synth, uint32_t seed);
+bool synthExpression(SynthChannel *synth, const char *expression);
+void synthQ14(SynthChannel *synth, int16_t *samples, uint32_t count);
+void synthWords(SynthChannel *synth, uint16_t *words, uint32_t count);
+void synthStreamWords(SynthChannel *a, SynthChannel *b, uint32_t *words, uint32_t count);
+void synthCalibrate(const SynthChannel *synth, const int16_t *samples, uint16_t *words, uint32_t count);
+const char *synthKernels();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
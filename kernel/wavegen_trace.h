@@ -0,0 +1,187 @@
+// WAVEGEN trace ring
+// Shared by the kernel driver and the user space library
+
+//-----------------------------------------------------------------------------
+// Trace configuration:
+//   WAVEGEN_TRACE_LEVEL selects at compile time which trace() calls are kept
+//     0 = none (default, trace() compiles to nothing)
+//     1 = errors
+//     2 = info
+//     3 = debug
+//   Kept calls store the format pointer and up to 4 int arguments in a
+//   lock-free ring; formatting only happens when the ring is dumped
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#ifndef WAVEGEN_TRACE_H
+#define WAVEGEN_TRACE_H
+
+#ifndef WAVEGEN_TRACE_LEVEL
+#define WAVEGEN_TRACE_LEVEL 0
+#endif
+
+#define TRACE_ERROR 1
+#define TRACE_INFO  2
+#define TRACE_DEBUG 3
+
+#define TRACE_RING_SIZE 64          // Entries, power of 2
+
+#ifdef __KERNEL__
+#include <linux/types.h>    // uint32_t
+#include <linux/atomic.h>   // atomic_t
+#include <linux/kernel.h>   // scnprintf
+
+typedef atomic_t wavegen_trace_index_t;
+typedef uint32_t wavegen_trace_seq_t;
+
+#define traceNextIndex(head)        ((uint32_t)atomic_inc_return(head))
+#define traceReadIndex(head)        ((uint32_t)atomic_read(head))
+#define traceStoreSeq(seq, value)   smp_store_release(seq, value)
+#define traceLoadSeq(seq)           smp_load_acquire(seq)
+#define traceWriteFence()           smp_wmb()
+#define traceReadFence()            smp_rmb()
+#define traceFormat                 scnprintf
+#else
+#include <stdint.h>         // C99 integer types -- uint32_t
+#include <stddef.h>         // size_t
+#include <stdio.h>          // vsnprintf
+#include <stdarg.h>         // va_list
+#include <stdatomic.h>      // atomic_uint
+
+typedef atomic_uint wavegen_trace_index_t;
+typedef _Atomic uint32_t wavegen_trace_seq_t;
+
+#define traceNextIndex(head)        (atomic_fetch_add_explicit(head, 1, memory_order_relaxed) + 1)
+#define traceReadIndex(head)        atomic_load_explicit(head, memory_order_acquire)
+#define traceStoreSeq(seq, value)   atomic_store_explicit(seq, value, memory_order_release)
+#define traceLoadSeq(seq)           atomic_load_explicit(seq, memory_order_acquire)
+#define traceWriteFence()           atomic_thread_fence(memory_order_release)
+#define traceReadFence()            atomic_thread_fence(memory_order_acquire)
+#define traceFormat                 traceScnprintf
+
+// snprintf returning the characters actually written, like the kernel's scnprintf
+static inline int traceScnprintf(char *buffer, size_t size, const char *format, ...)
+{
+    va_list args;
+    int length;
+
+    if (size == 0)
+        return 0;
+
+    va_start(args, format);
+    length = vsnprintf(buffer, size, format, args);
+    va_end(args);
+
+    if (length < 0)                 return 0;
+    if ((size_t)length >= size)     return size - 1;
+    return length;
+}
+#endif
+
+struct wavegen_trace_entry
+{
+    wavegen_trace_seq_t sequence;           // Index of the entry, 0 while being written
+    const char *function;
+    const char *format;
+    int args[4];
+};
+
+struct wavegen_trace
+{
+    wavegen_trace_index_t head;             // Index of the last entry written
+    struct wavegen_trace_entry ring[TRACE_RING_SIZE];
+};
+
+extern struct wavegen_trace wavegenTrace;
+
+// Record a trace event if level is compiled in (arguments must be ints)
+#define trace(level, format, ...)                                                       \
+    do                                                                                  \
+    {                                                                                   \
+        if ((level) <= WAVEGEN_TRACE_LEVEL)                                             \
+            traceRecord(&wavegenTrace, __func__, format, (int[4]){ __VA_ARGS__ });      \
+    } while (0)
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+/**
+ *      @brief Function to add an entry to the trace ring
+ *                (Any number of writers, no locks)
+ *      @param trace ring to write
+ *      @param function name of the caller
+ *      @param format printf style format of the entry
+ *      @param args up to 4 int arguments of the format
+ **/
+static inline void traceRecord(struct wavegen_trace *trace, const char *function, const char *format, const int *args)
+{
+    uint32_t index = traceNextIndex(&trace->head);
+    struct wavegen_trace_entry *entry = &trace->ring[index & (TRACE_RING_SIZE - 1)];
+
+    traceStoreSeq(&entry->sequence, 0);
+    traceWriteFence();
+
+    entry->function = function;
+    entry->format   = format;
+    entry->args[0]  = args[0];
+    entry->args[1]  = args[1];
+    entry->args[2]  = args[2];
+    entry->args[3]  = args[3];
+
+    traceStoreSeq(&entry->sequence, index);
+}
+
+/**
+ *      @brief Function to format one entry of the trace ring
+ *      @param trace ring to read
+ *      @param index entry to format, from traceFirst() up to traceLast()
+ *      @param buffer line to write
+ *      @param size of buffer
+ *      @return int characters written, 0 if the entry was empty or overwritten
+ **/
+static inline int traceLine(struct wavegen_trace *trace, uint32_t index, char *buffer, size_t size)
+{
+    struct wavegen_trace_entry *entry = &trace->ring[index & (TRACE_RING_SIZE - 1)];
+    struct wavegen_trace_entry copy;
+    int length;
+
+    if (traceLoadSeq(&entry->sequence) != index)
+        return 0;
+
+    copy.function = entry->function;
+    copy.format   = entry->format;
+    copy.args[0]  = entry->args[0];
+    copy.args[1]  = entry->args[1];
+    copy.args[2]  = entry->args[2];
+    copy.args[3]  = entry->args[3];
+
+    // Discard the copy if a writer reused the entry meanwhile
+    traceReadFence();
+    if (traceLoadSeq(&entry->sequence) != index)
+        return 0;
+
+    length  = traceFormat(buffer, size, "[%u][%s] ", index, copy.function);
+    length += traceFormat(buffer + length, size - length, copy.format,
+                          copy.args[0], copy.args[1], copy.args[2], copy.args[3]);
+    length += traceFormat(buffer + length, size - length, "\n");
+
+    return length;
+}
+
+static inline uint32_t traceLast(struct wavegen_trace *trace)
+{
+    return traceReadIndex(&trace->head);
+}
+
+static inline uint32_t traceFirst(struct wavegen_trace *trace)
+{
+    uint32_t last = traceLast(trace);
+
+    return (last < TRACE_RING_SIZE) ? 1 : last - TRACE_RING_SIZE + 1;
+}
+
+#endif
@@ -0,0 +1,78 @@
+`timescale 1ns / 1ps
+//////////////////////////////////////////////////////////////////////////////////
+// Company:
+// Engineer:
+//
+// Create Date:
+// Design Name:
+// Module Name: arbWave
+// Project Name:
+// Target Devices:
+// Tool Versions:
+// Description: Arbitrary waveform sample tables of every channel in one dual
+//              port BRAM: port A is written from the AXI bus (arbw_W_O),
+//              port B is read by samplePipeline at the phase word of the
+//              channel being computed.
+//              Samples are signed Q14 (-16384..16383), same scale as the sine LUT.
+//
+// Dependencies:
+//
+// Revision:
+// Revision 0.01 - File Created
+// Revision 0.02 - Tables only, playback moved to samplePipeline
+// Revision 0.03 - One table per channel, CHANNELS tables
+// Additional Comments:
+//   Sample write bus (one AXI clock per sample):
+//     [31]    write strobe
+//     [30:26] channel
+//     [25:16] sample index
+//     [15:0]  sample
+//   rd_data is valid READ_LATENCY clocks after rd_channel/rd_index.
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+
+module arbWave #
+    (
+        parameter integer CHANNELS = 2,
+        parameter integer ARB_BITS = 10,                // 2^ARB_BITS samples per channel
+        parameter integer READ_LATENCY = 2,             // Clocks from address to rd_data, 1 or more
+        localparam integer CH_BITS = (CHANNELS > 1) ? $clog2(CHANNELS) : 1
+    )
+    (
+    input clk,
+
+    input wr_clk,                                       // AXI clock
+    input [31:0] wr_sample,                             // Sample write bus
+
+    input [CH_BITS - 1:0] rd_channel,
+    input [ARB_BITS - 1:0] rd_index,
+    output reg signed [15:0] rd_data
+    );
+
+//SAMPLE BRAM, channel in the top address bits
+    (* ram_style = "block" *) reg signed [15:0] table_R [0:(CHANNELS << ARB_BITS) - 1];
+
+    wire wr_strobe                  = wr_sample[31];
+    wire [4:0] wr_channel_all       = wr_sample[30:26];
+    wire [CH_BITS - 1:0] wr_channel = wr_channel_all[CH_BITS - 1:0];
+    wire [ARB_BITS - 1:0] wr_index  = wr_sample[16 +: ARB_BITS];
+
+    // Port A: AXI writes
+    always_ff @(posedge wr_clk) begin
+        if (wr_strobe && wr_channel_all < CHANNELS)  table_R[{wr_channel, wr_index}] <= wr_sample[15:0];
+    end
+
+    // Port B: playback reads, registered READ_LATENCY times
+    reg signed [15:0] read_R [0:READ_LATENCY - 1];
+    integer i;
+
+    always_ff @(posedge clk) begin
+        read_R[0] <= table_R[{rd_channel, rd_index}];
+        for (i = 1; i < READ_LATENCY; i = i + 1)
+            read_R[i] <= read_R[i - 1];
+    end
+
+    assign rd_data = read_R[READ_LATENCY - 1];
+
+endmodule
@@ -0,0 +1,329 @@
+`timescale 1ns / 1ps
+//////////////////////////////////////////////////////////////////////////////////
+// Company:
+// Engineer:
+//
+// Create Date:
+// Design Name:
+// Module Name: samplePipeline
+// Project Name:
+// Target Devices:
+// Tool Versions:
+// Description: One waveform datapath shared by every channel.
+//              On each sampling pulse the channels are issued one per clock
+//              into phase -> shape -> gain -> offset -> calibration, so a
+//              single gain multiplier and a single calibration multiplier
+//              serve every mode of every channel (replaces dcOut, sineWave,
+//              ddsWave, the playback half of arbWave and phaseAccumulator).
+//
+// Dependencies: sineLut (quarter wave sine), arbWave (sample tables)
+//
+// Revision:
+// Revision 0.01 - File Created
+// Revision 0.02 - Sample tables of every channel
+// Revision 0.03 - Interpolated quarter wave sine instead of blk_mem_gen_1
+// Revision 0.04 - Phase offsets and phase synchronous restart
+// Revision 0.05 - Hilbert (quadrature) output from the other channel of the pair
+// Revision 0.06 - Bursts of cycles periods per trigger
+// Additional Comments:
+//   Shapes over one period (phase 0 to 2^32), Q14 before amplitude:
+//     dc:   0 (offset only)
+//     sine: sineLut, interpolated from all 32 phase bits
+//     saw:  -1 rising to +1
+//     tri:  -1 rising to +1 at half period, back to -1
+//     sq:   +1 while phase < duty, -1 after (duty 0 = 50%)
+//     arb:  sample table
+//   The shapes read phase + phase_ofs * 2^16. Offsets are latched on the
+//   sampling pulse, so a write moves every channel on the same sample.
+//   A rising phase_sync bit restarts that channel at phase 0 on the next
+//   sample; channels started by one register write stay phase aligned.
+//   A channel with its hilbert bit set follows the phase of the other
+//   channel of its DAC (n ^ 1) and outputs its Hilbert transform: the sine
+//   90 degrees behind, the triangle from the Hilbert table of sineLut.
+//   Other modes ignore the bit.
+//   A channel with cycles != 0 rests at phase 0 until triggered (trig_sw
+//   toggle, or a trig_ext rising edge when enabled), then runs cycles
+//   periods from phase 0, counting accumulator wraps, and rests at phase 0
+//   again; burst_done toggles at the end. Triggers during a burst are
+//   ignored. With cycles = 0 the channel runs continuously.
+//   The last channel is written MEM_LATENCY + 5 + CHANNELS clocks after the
+//   sampling pulse, far inside one sample period.
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+
+module samplePipeline #
+    (
+        parameter integer CHANNELS    = 2,
+        parameter integer ARB_BITS    = 10,             // 2^ARB_BITS arbitrary samples per channel
+        parameter integer MEM_LATENCY = 2               // Clocks from phase to table data, 2 or more
+    )
+    (
+    input clk,
+    input clk_sampling,
+
+    input [CHANNELS*3-1:0]  mode,                       // Channel n in bits [n*3 +: 3]
+    input [CHANNELS*32-1:0] delta_phase,                // freq * 2^32 / sample rate
+    input [CHANNELS*16-1:0] ampl,                       // Q14
+    input [CHANNELS*16-1:0] dc_ofs,                     // Q14
+    input [CHANNELS*16-1:0] duty,                       // Q14 fraction of the period
+    input [CHANNELS*16-1:0] phase_ofs,                  // Fraction of the period, 2^16 = 360 degrees
+    input [CHANNELS-1:0]    phase_sync,                 // Run bits, rising edge restarts the channel
+    input [CHANNELS-1:0]    hilbert,                    // Quadrature of the other channel of the pair
+    input [CHANNELS*16-1:0] cycles,                     // Periods per burst, 0 = continuous
+    input [CHANNELS-1:0]    trig_sw,                    // Software triggers, toggle once per trigger
+    input [CHANNELS-1:0]    trig_ext_en,                // Channels started by trig_ext
+    input                   trig_ext,                   // External trigger, rising edge, asynchronous
+    input [CHANNELS*16-1:0] cal_slope,                  // Calibration slope, gain 2048 = 1
+    input [CHANNELS*12-1:0] cal_intercept,              // Calibration intercept, DAC codes
+
+    input wr_clk,                                       // Arbitrary sample writes (arbw_W_O)
+    input [31:0] wr_sample,
+
+    output reg [CHANNELS*12-1:0] dac_words,             // Channel n in bits [n*12 +: 12]
+    output reg [CHANNELS-1:0] burst_done = 0,           // Toggles once per finished burst
+    output reg busy = 1'b0
+    );
+
+    localparam integer CH_BITS = (CHANNELS > 1) ? $clog2(CHANNELS) : 1;
+
+    reg [7:0] calibration_scale = 8'd11;
+    reg [7:0] default_fp_scale = 8'd14;
+
+//ISSUE, one channel per clock after the sampling pulse
+    reg issuing = 1'b0;
+    reg [CH_BITS-1:0] issue_ch = 0;
+
+    always_ff @(posedge clk) begin
+        if (clk_sampling) begin
+            issuing  <= 1'b1;
+            issue_ch <= 0;
+        end
+        else if (issuing) begin
+            if (issue_ch == CHANNELS - 1)   issuing  <= 1'b0;
+            else                            issue_ch <= issue_ch + 1;
+        end
+    end
+
+//PHASE, one 32 bit accumulator per channel
+    reg [31:0] phase_R [0:CHANNELS-1];
+    integer i;
+
+    initial begin
+        for (i = 0; i < CHANNELS; i = i + 1)
+            phase_R[i] = 32'd0;
+    end
+
+    // Offsets, restarts and triggers take effect together on a sampling pulse
+    reg [CHANNELS*16-1:0] ofs_R = 0;
+    reg [CHANNELS-1:0] sync_last = 0;
+    reg [CHANNELS-1:0] sync_pending = 0;
+    reg [CHANNELS-1:0] sync_R = 0;
+
+    reg [CHANNELS-1:0] trig_S1 = 0, trig_S2 = 0, trig_S3 = 0;
+    reg [2:0] ext_S = 3'b000;
+    wire ext_rise = ext_S[1] & ~ext_S[2];
+    wire [CHANNELS-1:0] trig_now = (trig_S2 ^ trig_S3) | (ext_rise ? trig_ext_en : {CHANNELS{1'b0}});
+    reg [CHANNELS-1:0] trig_pending = 0;
+    reg [CHANNELS-1:0] trig_R = 0;
+
+    always_ff @(posedge clk) begin
+        sync_last <= phase_sync;
+        trig_S1   <= trig_sw;
+        trig_S2   <= trig_S1;
+        trig_S3   <= trig_S2;
+        ext_S     <= {ext_S[1:0], trig_ext};
+
+        if (clk_sampling) begin
+            ofs_R        <= phase_ofs;
+            sync_R       <= sync_pending;
+            sync_pending <= phase_sync & ~sync_last;
+            trig_R       <= trig_pending;
+            trig_pending <= trig_now;
+        end
+        else begin
+            sync_pending <= sync_pending | (phase_sync & ~sync_last);
+            trig_pending <= trig_pending | trig_now;
+        end
+    end
+
+    // Bursts, one wrap counter per channel
+    reg [CHANNELS-1:0] burst_active = 0;
+    reg [15:0] burst_count [0:CHANNELS-1];
+    reg [CHANNELS-1:0] hold;                            // Channel reads phase 0 this sample
+    integer h;
+
+    always_comb begin
+        for (h = 0; h < CHANNELS; h = h + 1)
+            hold[h] = sync_R[h] || (cycles[h*16 +: 16] != 16'd0 && !burst_active[h]);
+    end
+
+    wire [15:0] issue_cycles = cycles[issue_ch*16 +: 16];
+
+    wire [31:0] phase_now  = hold[issue_ch] ? 32'd0 : phase_R[issue_ch];
+    wire [32:0] phase_next = {1'b0, phase_now} + {1'b0, delta_phase[issue_ch*32 +: 32]};     // Bit 32 is a wrap
+    wire [31:0] phase_own  = phase_now + {ofs_R[issue_ch*16 +: 16], 16'd0};
+
+    // Phase of the other channel of the pair in this sample: already issued
+    // for odd channels, read ahead from its accumulator for even ones
+    reg [31:0] own_R [0:CHANNELS-1];
+    wire [CH_BITS-1:0] pair_ch = issue_ch ^ 1'b1;
+    wire [31:0] pair_now  = hold[pair_ch] ? 32'd0 : phase_R[pair_ch];
+    wire [31:0] pair_own  = (pair_ch < issue_ch) ? own_R[pair_ch] : pair_now + {ofs_R[pair_ch*16 +: 16], 16'd0};
+
+    wire        issue_hilb = hilbert[issue_ch];
+    wire [2:0]  issue_mode = mode[issue_ch*3 +: 3];
+    wire [31:0] phase_read = issue_hilb ? pair_own + {ofs_R[issue_ch*16 +: 16], 16'd0} : phase_own;
+
+    // Operands of each channel in flight while the tables are read
+    reg                 mem_valid [0:MEM_LATENCY];
+    reg [CH_BITS-1:0]   mem_ch    [0:MEM_LATENCY];
+    reg [31:0]          mem_phase [0:MEM_LATENCY];
+
+    reg [31:0] lut_phase;
+    reg lut_select;
+    reg [ARB_BITS-1:0] arb_index;
+    reg [CH_BITS-1:0] arb_ch;
+
+    always_ff @(posedge clk) begin
+        if (issuing) begin
+            own_R[issue_ch] <= phase_own;
+
+            if (issue_cycles == 16'd0) begin                                // Continuous
+                phase_R[issue_ch]      <= phase_next[31:0];
+                burst_active[issue_ch] <= 1'b0;
+            end
+            else if (burst_active[issue_ch]) begin
+                if (phase_next[32] && burst_count[issue_ch] + 16'd1 == issue_cycles) begin
+                    phase_R[issue_ch]      <= 32'd0;                        // Last period done, rest at phase 0
+                    burst_active[issue_ch] <= 1'b0;
+                    burst_done[issue_ch]   <= ~burst_done[issue_ch];
+                end
+                else begin
+                    phase_R[issue_ch]      <= phase_next[31:0];
+                    burst_count[issue_ch]  <= burst_count[issue_ch] + phase_next[32];
+                end
+            end
+            else if (trig_R[issue_ch]) begin                                // Start from phase 0
+                phase_R[issue_ch]      <= phase_next[31:0];
+                burst_count[issue_ch]  <= 16'd0;
+                burst_active[issue_ch] <= 1'b1;
+            end
+            else begin
+                phase_R[issue_ch]      <= 32'd0;
+            end
+        end
+
+        lut_phase    <= (issue_hilb && issue_mode == 3'd1) ? phase_read - 32'h40000000 : phase_read;   // Sine 90 degrees behind
+        lut_select   <= issue_hilb && issue_mode == 3'd3;                                               // Hilbert of the triangle
+        arb_index    <= phase_read >> (32 - ARB_BITS);
+        arb_ch       <= issue_ch;
+
+        mem_valid[0] <= issuing;
+        mem_ch[0]    <= issue_ch;
+        mem_phase[0] <= phase_read;
+        for (i = 1; i <= MEM_LATENCY; i = i + 1) begin
+            mem_valid[i] <= mem_valid[i - 1];
+            mem_ch[i]    <= mem_ch[i - 1];
+            mem_phase[i] <= mem_phase[i - 1];
+        end
+    end
+
+//TABLES
+    wire signed [15:0] lut_data;
+    wire signed [15:0] arb_data;
+
+    sineLut #(
+        .LATENCY(MEM_LATENCY)
+    ) sine_table (
+        .clk(clk),
+        .phase(lut_phase),
+        .select(lut_select),
+        .sample(lut_data)
+    );
+
+    arbWave #(
+        .CHANNELS(CHANNELS),
+        .ARB_BITS(ARB_BITS),
+        .READ_LATENCY(MEM_LATENCY)
+    ) arb_tables (
+        .clk(clk),
+        .wr_clk(wr_clk),
+        .wr_sample(wr_sample),
+        .rd_channel(arb_ch),
+        .rd_index(arb_index),
+        .rd_data(arb_data)
+    );
+
+//SHAPE
+    wire [CH_BITS-1:0] s_ch    = mem_ch[MEM_LATENCY];
+    wire [31:0]        s_phase = mem_phase[MEM_LATENCY];
+    wire [2:0]         s_mode  = mode[s_ch*3 +: 3];
+    wire [15:0]        s_duty  = (duty[s_ch*16 +: 16] == 16'd0) ? 16'd8192 : duty[s_ch*16 +: 16];
+    wire [15:0]        s_fold  = s_phase[31] ? ~s_phase[30:15] : s_phase[30:15];    // Up then down
+
+    reg signed [15:0] shape;
+    reg shape_valid = 1'b0;
+    reg [CH_BITS-1:0] shape_ch;
+
+    always_ff @(posedge clk) begin
+        shape_valid <= mem_valid[MEM_LATENCY];
+        shape_ch    <= s_ch;
+
+        case (s_mode)
+            3'd1:    shape <= lut_data;
+            3'd2:    shape <= $signed({~s_phase[31], s_phase[30:16]}) >>> 1;
+            3'd3:    shape <= hilbert[s_ch] ? lut_data : $signed({~s_fold[15], s_fold[14:0]}) >>> 1;
+            3'd4:    shape <= ({2'b00, s_phase[31:18]} < s_duty) ? 16'sd16384 : -16'sd16384;
+            3'd5:    shape <= arb_data;
+            default: shape <= 16'sd0;
+        endcase
+    end
+
+//GAIN
+    reg signed [31:0] gained;
+    reg gain_valid = 1'b0;
+    reg [CH_BITS-1:0] gain_ch;
+
+    always_ff @(posedge clk) begin
+        gain_valid <= shape_valid;
+        gain_ch    <= shape_ch;
+        gained     <= (shape * $signed(ampl[shape_ch*16 +: 16])) >>> default_fp_scale;
+    end
+
+//DC OFFSET IMPLEMENTATION
+    reg signed [15:0] sample_signed;
+    reg offset_valid = 1'b0;
+    reg [CH_BITS-1:0] offset_ch;
+
+    always_ff @(posedge clk) begin
+        offset_valid  <= gain_valid;
+        offset_ch     <= gain_ch;
+        sample_signed <= (gained + $signed(dc_ofs[gain_ch*16 +: 16])) >>> 3;   // Convert a 16383 swing and Limit it to a swing of -2048 to 2048
+    end
+
+//CALIBRATION MODULE
+    reg [31:0] sample_gained;
+    reg cal_valid = 1'b0;
+    reg [CH_BITS-1:0] cal_ch;
+
+    always_ff @(posedge clk) begin
+        cal_valid     <= offset_valid;
+        cal_ch        <= offset_ch;
+        sample_gained <= ((sample_signed * $signed(cal_slope[offset_ch*16 +: 16])) >> calibration_scale);
+    end
+
+    wire [15:0] sample_unsigned = sample_gained + cal_intercept[cal_ch*12 +: 12] + 16'd2048;  // Map to 0-4096 for the DAC words
+
+    always_ff @(posedge clk) begin
+        if (clk_sampling)
+            busy <= 1'b1;
+
+        if (cal_valid) begin
+            dac_words[cal_ch*12 +: 12] <= sample_unsigned[11:0];               // Grab the last 11 bits to send to SPI
+            if (cal_ch == CHANNELS - 1)
+                busy <= 1'b0;
+        end
+    end
+
+endmodule
@@ -0,0 +1,174 @@
+`timescale 1ns / 1ps
+//////////////////////////////////////////////////////////////////////////////////
+// Company:
+// Engineer:
+//
+// Create Date:
+// Design Name:
+// Module Name: samplePipeline_tb
+// Project Name:
+// Target Devices:
+// Tool Versions:
+// Description: Replays a stimulus file of kernel/wavegen_model_check on
+//              samplePipeline and dumps dac_words and burst_done after every
+//              sampling pulse, for comparison with the golden model
+//              (kernel/wavegen_model.c).
+//
+// Dependencies: samplePipeline, sineLut, arbWave
+//
+// Revision:
+// Revision 0.01 - File Created
+// Additional Comments:
+//   iverilog -g2012 -o tb samplePipeline_tb.sv samplePipeline.sv sineLut.sv arbWave.sv
+//   vvp tb +stimulus=stimulus.txt +dump=rtl.txt
+//   CHANNELS must match the channel count in the stimulus header
+//   (-P samplePipeline_tb.CHANNELS=n).
+//   Each record is applied SETTLE clocks before its sampling pulse so run
+//   edges and triggers pass their synchronizers first.
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+
+module samplePipeline_tb #
+    (
+        parameter integer CHANNELS = 2,
+        parameter integer SETTLE   = 8                  // Clocks from a record to its sampling pulse
+    )
+    ();
+
+    reg clk = 1'b0;
+    reg clk_sampling = 1'b0;
+
+    reg [CHANNELS*3-1:0]  mode = 0;
+    reg [CHANNELS*32-1:0] delta_phase = 0;
+    reg [CHANNELS*16-1:0] ampl = 0;
+    reg [CHANNELS*16-1:0] dc_ofs = 0;
+    reg [CHANNELS*16-1:0] duty = 0;
+    reg [CHANNELS*16-1:0] phase_ofs = 0;
+    reg [CHANNELS-1:0]    phase_sync = 0;
+    reg [CHANNELS-1:0]    hilbert = 0;
+    reg [CHANNELS*16-1:0] cycles = 0;
+    reg [CHANNELS-1:0]    trig_sw = 0;
+    reg [CHANNELS-1:0]    trig_ext_en = 0;
+    reg                   trig_ext = 1'b0;
+    reg [31:0]            wr_sample = 0;
+
+    wire [CHANNELS*16-1:0] cal_slope;
+    wire [CHANNELS*12-1:0] cal_intercept;
+    wire [CHANNELS*12-1:0] dac_words;
+    wire [CHANNELS-1:0]    burst_done;
+    wire busy;
+
+    // Calibration of wavegen_system_top
+    genvar ch;
+    generate
+        for (ch = 0; ch < CHANNELS; ch = ch + 1)
+        begin : calibration
+            assign cal_slope[ch*16 +: 16]     = (ch == 0) ? 16'd1961 : (ch == 1) ? 16'd1947 : 16'd2048;
+            assign cal_intercept[ch*12 +: 12] = (ch == 0) ? 12'd24   : (ch == 1) ? 12'd33   : 12'd0;
+        end
+    endgenerate
+
+    samplePipeline #(
+        .CHANNELS(CHANNELS)
+    ) dut (
+        .clk(clk),
+        .clk_sampling(clk_sampling),
+        .mode(mode),
+        .delta_phase(delta_phase),
+        .ampl(ampl),
+        .dc_ofs(dc_ofs),
+        .duty(duty),
+        .phase_ofs(phase_ofs),
+        .phase_sync(phase_sync),
+        .hilbert(hilbert),
+        .cycles(cycles),
+        .trig_sw(trig_sw),
+        .trig_ext_en(trig_ext_en),
+        .trig_ext(trig_ext),
+        .cal_slope(cal_slope),
+        .cal_intercept(cal_intercept),
+        .wr_clk(clk),
+        .wr_sample(wr_sample),
+        .dac_words(dac_words),
+        .burst_done(burst_done),
+        .busy(busy)
+    );
+
+    always #5 clk = ~clk;                               // 100 MHz
+
+    integer stimulus, dump, fields, c, n;
+    reg [1023:0] stimulus_name, dump_name;
+    reg [31:0] channels, records, kind, ext;
+    reg [31:0] v [0:10];
+    reg [31:0] a, b, d;
+
+    initial begin
+        if (!$value$plusargs("stimulus=%s", stimulus_name))  stimulus_name = "stimulus.txt";
+        if (!$value$plusargs("dump=%s", dump_name))          dump_name     = "rtl.txt";
+
+        stimulus = $fopen(stimulus_name, "r");
+        dump     = $fopen(dump_name, "w");
+        if (stimulus == 0 || dump == 0) begin
+            $display("cannot open %0s or %0s", stimulus_name, dump_name);
+            $finish;
+        end
+
+        fields = $fscanf(stimulus, "%h %h", channels, records);
+        if (fields != 2 || channels != CHANNELS) begin
+            $display("%0s: %0d channels, samplePipeline_tb.CHANNELS is %0d", stimulus_name, channels, CHANNELS);
+            $finish;
+        end
+
+        n = 0;
+        repeat (SETTLE) @(posedge clk);
+
+        while ($fscanf(stimulus, "%h", kind) == 1) begin
+            if (kind == 0) begin
+                // Arbitrary sample write, one clock
+                fields = $fscanf(stimulus, "%h %h %h", a, b, d);
+                @(negedge clk) wr_sample = {1'b1, a[4:0], b[9:0], d[15:0]};
+                @(negedge clk) wr_sample = 0;
+            end
+            else begin
+                fields = $fscanf(stimulus, "%h", ext);
+                @(negedge clk);
+                for (c = 0; c < CHANNELS; c = c + 1) begin
+                    fields = $fscanf(stimulus, "%h %h %h %h %h %h %h %h %h %h %h",
+                                     v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7], v[8], v[9], v[10]);
+                    mode[c*3 +: 3]          = v[0][2:0];
+                    delta_phase[c*32 +: 32] = v[1];
+                    ampl[c*16 +: 16]        = v[2][15:0];
+                    dc_ofs[c*16 +: 16]      = v[3][15:0];
+                    duty[c*16 +: 16]        = v[4][15:0];
+                    phase_ofs[c*16 +: 16]   = v[5][15:0];
+                    phase_sync[c]           = v[6][0];
+                    hilbert[c]              = v[7][0];
+                    cycles[c*16 +: 16]      = v[8][15:0];
+                    trig_sw[c]              = v[9][0];
+                    trig_ext_en[c]          = v[10][0];
+                end
+                trig_ext = ext[0];
+
+                // Sampling pulse, then wait for the last channel
+                repeat (SETTLE) @(negedge clk);
+                clk_sampling = 1'b1;
+                @(negedge clk) clk_sampling = 1'b0;
+                @(negedge clk);
+                while (busy) @(negedge clk);
+
+                $fwrite(dump, "%0d", n);
+                for (c = 0; c < CHANNELS; c = c + 1)
+                    $fwrite(dump, " %h", dac_words[c*12 +: 12]);
+                $fwrite(dump, " %h\n", burst_done);
+                n = n + 1;
+            end
+        end
+
+        $fclose(stimulus);
+        $fclose(dump);
+        $display("%0d samples written to %0s", n, dump_name);
+        $finish;
+    end
+
+endmodule
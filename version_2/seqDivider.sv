@@ -0,0 +1,70 @@
+`timescale 1ns / 1ps
+//////////////////////////////////////////////////////////////////////////////////
+// Company:
+// Engineer:
+//
+// Create Date:
+// Design Name:
+// Module Name: seqDivider
+// Project Name:
+// Target Devices:
+// Tool Versions:
+// Description: Restoring divider, one quotient bit per clock.
+//              Replaces the combinational dividers of the mode select logic,
+//              which only need a new result when a register is written.
+//
+// Dependencies:
+//
+// Revision:
+// Revision 0.01 - File Created
+// Additional Comments:
+//   start loads the operands, done pulses for one clock WIDTH clocks later
+//   with the quotient valid until the next start.
+//   Dividing by 0 gives all ones.
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+
+module seqDivider #
+    (
+        parameter integer WIDTH = 64                    // Dividend and quotient width
+    )
+    (
+    input clk,
+    input start,
+    input [WIDTH-1:0] dividend,
+    input [31:0] divisor,
+
+    output reg [WIDTH-1:0] quotient,
+    output reg done = 1'b0
+    );
+
+    reg [31:0] remainder;
+    reg [31:0] divisor_R;
+    reg [7:0] count = 8'd0;                             // Quotient bits left
+    wire [32:0] trial = {remainder, quotient[WIDTH-1]}; // Remainder with the next dividend bit
+
+    always_ff @(posedge clk) begin
+        done <= 1'b0;
+
+        if (start) begin
+            quotient  <= dividend;                      // Dividend bits shift out as quotient bits shift in
+            remainder <= 32'd0;
+            divisor_R <= divisor;
+            count     <= WIDTH;
+        end
+        else if (count != 0) begin
+            if (trial >= {1'b0, divisor_R}) begin
+                remainder <= trial - divisor_R;
+                quotient  <= {quotient[WIDTH-2:0], 1'b1};
+            end
+            else begin
+                remainder <= trial[31:0];
+                quotient  <= {quotient[WIDTH-2:0], 1'b0};
+            end
+            count <= count - 1;
+            done  <= (count == 1);
+        end
+    end
+
+endmodule
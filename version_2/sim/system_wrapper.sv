@@ -0,0 +1,226 @@
+`timescale 1ns / 1ps
+//////////////////////////////////////////////////////////////////////////////////
+// Company:
+// Engineer:
+//
+// Create Date:
+// Design Name:
+// Module Name: system_wrapper
+// Project Name:
+// Target Devices:
+// Tool Versions:
+// Description: Simulation stand-in for the Vivado block design (Verilator only).
+//              The PS is replaced by an AXI4-Lite master whose transfers come
+//              from the C++ harness through DPI (simAxiRequest and
+//              simAxiResponse in wavegen_sim.cpp); it drives the real
+//              wavegen_soc IP, so the register outputs behave like on the
+//              board. The DMA stream is idle.
+//
+// Dependencies: wavegen_soc_v1_0, wavegen_soc_v1_0_AXI
+//
+// Revision:
+// Revision 0.01 - File Created
+// Additional Comments:
+//   FCLK_CLK0 (the AXI clock) is taken from FIXED_IO_ps_clk, which the
+//   harness toggles with CLK100; the PS reference clock is 33.3 MHz on the
+//   board, the PLL is not modelled.
+//   CHANNELS comes from +define+WAVEGEN_CHANNELS, the wrapper is
+//   instantiated without parameters.
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+`ifndef WAVEGEN_CHANNELS
+`define WAVEGEN_CHANNELS 2
+`endif
+
+module system_wrapper #
+    (
+        parameter integer CHANNELS = `WAVEGEN_CHANNELS
+    )
+    (
+    inout [14:0]DDR_addr,
+    inout [2:0]DDR_ba,
+    inout DDR_cas_n,
+    inout DDR_ck_n,
+    inout DDR_ck_p,
+    inout DDR_cke,
+    inout DDR_cs_n,
+    inout [3:0]DDR_dm,
+    inout [31:0]DDR_dq,
+    inout [3:0]DDR_dqs_n,
+    inout [3:0]DDR_dqs_p,
+    inout DDR_odt,
+    inout DDR_ras_n,
+    inout DDR_reset_n,
+    inout DDR_we_n,
+    inout FIXED_IO_ddr_vrn,
+    inout FIXED_IO_ddr_vrp,
+    inout [53:0]FIXED_IO_mio,
+    inout FIXED_IO_ps_clk,
+    inout FIXED_IO_ps_porb,
+    inout FIXED_IO_ps_srstb,
+
+    output [CHANNELS*16-1:0] ampl_W_O,
+    output [CHANNELS*16-1:0] cycl_W_O,
+    output [31:0] srat_W_O,
+    output [CHANNELS*16-1:0] dCyc_W_O,
+    output [CHANNELS*32-1:0] freq_W_O,
+    output [CHANNELS*3-1:0] mode_W_O,
+    output [CHANNELS*16-1:0] ofst_W_O,
+    output [CHANNELS*16-1:0] phas_W_O,
+    output [CHANNELS-1:0] runn_W_O,
+    output [CHANNELS-1:0] hilb_W_O,
+    output [CHANNELS-1:0] comp_W_O,
+    output [CHANNELS-1:0] trig_W_O,
+    output [CHANNELS-1:0] trgx_W_O,
+    input [CHANNELS-1:0] bdon_W_I,
+    output [31:0] arbw_W_O,
+    output arbc_W_O,
+
+    output [31:0] SAMP_AXIS_tdata,
+    output SAMP_AXIS_tvalid,
+    input SAMP_AXIS_tready,
+    output SAMP_AXIS_aclk
+    );
+
+    import "DPI-C" function int simAxiRequest(output int address, output int data);   // 0 none, 1 write, 2 read
+    import "DPI-C" function void simAxiResponse(input int data);                      // Read data, 0 after a write
+
+    wire aclk = FIXED_IO_ps_clk;
+
+//RESET, 16 clocks after power up
+    reg [4:0] reset_count = 5'd0;
+    wire aresetn = reset_count[4];
+
+    always_ff @(posedge aclk) begin
+        if (!aresetn)
+            reset_count <= reset_count + 1;
+    end
+
+//AXI4-LITE MASTER, one transfer at a time
+    localparam integer AXI_IDLE = 0, AXI_WRITE = 1, AXI_WRESP = 2, AXI_READ = 3, AXI_RDATA = 4;
+
+    reg [2:0] axi_state = AXI_IDLE;
+    reg [15:0] awaddr, araddr;
+    reg [31:0] wdata;
+    reg awvalid = 1'b0, wvalid = 1'b0, bready = 1'b0, arvalid = 1'b0, rready = 1'b0;
+    wire awready, wready, bvalid, arready, rvalid;
+    wire [1:0] bresp, rresp;
+    wire [31:0] rdata;
+    wire irq;                                           // Not routed to a PS model
+
+    int request, address, data;
+
+    always @(posedge aclk) begin
+        if (aresetn) begin
+            case (axi_state)
+                AXI_IDLE:
+                begin
+                    request = simAxiRequest(address, data);
+                    if (request == 1) begin
+                        awaddr    <= address[15:0];
+                        wdata     <= data;
+                        awvalid   <= 1'b1;
+                        wvalid    <= 1'b1;
+                        axi_state <= AXI_WRITE;
+                    end
+                    else if (request == 2) begin
+                        araddr    <= address[15:0];
+                        arvalid   <= 1'b1;
+                        axi_state <= AXI_READ;
+                    end
+                end
+
+                AXI_WRITE:
+                begin
+                    if (awready)    awvalid <= 1'b0;
+                    if (wready)     wvalid  <= 1'b0;
+                    if ((awready || !awvalid) && (wready || !wvalid)) begin
+                        bready    <= 1'b1;
+                        axi_state <= AXI_WRESP;
+                    end
+                end
+
+                AXI_WRESP:
+                begin
+                    if (bvalid) begin
+                        bready    <= 1'b0;
+                        axi_state <= AXI_IDLE;
+                        simAxiResponse(0);
+                    end
+                end
+
+                AXI_READ:
+                begin
+                    if (arready) begin
+                        arvalid   <= 1'b0;
+                        rready    <= 1'b1;
+                        axi_state <= AXI_RDATA;
+                    end
+                end
+
+                AXI_RDATA:
+                begin
+                    if (rvalid) begin
+                        rready    <= 1'b0;
+                        axi_state <= AXI_IDLE;
+                        simAxiResponse(rdata);
+                    end
+                end
+
+                default:
+                    axi_state <= AXI_IDLE;
+            endcase
+        end
+    end
+
+//WAVEGEN IP
+    wavegen_soc_v1_0 #(
+        .CHANNELS(CHANNELS)
+    ) wavegen_soc (
+        .mode_W_O(mode_W_O),
+        .runn_W_O(runn_W_O),
+        .hilb_W_O(hilb_W_O),
+        .comp_W_O(comp_W_O),
+        .freq_W_O(freq_W_O),
+        .ofst_W_O(ofst_W_O),
+        .ampl_W_O(ampl_W_O),
+        .dCyc_W_O(dCyc_W_O),
+        .cycl_W_O(cycl_W_O),
+        .phas_W_O(phas_W_O),
+        .srat_W_O(srat_W_O),
+        .arbw_W_O(arbw_W_O),
+        .arbc_W_O(arbc_W_O),
+        .trig_W_O(trig_W_O),
+        .trgx_W_O(trgx_W_O),
+        .bdon_W_I(bdon_W_I),
+        .irq(irq),
+        .axi_aclk(aclk),
+        .axi_aresetn(aresetn),
+        .axi_awaddr(awaddr),
+        .axi_awprot(3'b000),
+        .axi_awvalid(awvalid),
+        .axi_awready(awready),
+        .axi_wdata(wdata),
+        .axi_wstrb(4'b1111),
+        .axi_wvalid(wvalid),
+        .axi_wready(wready),
+        .axi_bresp(bresp),
+        .axi_bvalid(bvalid),
+        .axi_bready(bready),
+        .axi_araddr(araddr),
+        .axi_arprot(3'b000),
+        .axi_arvalid(arvalid),
+        .axi_arready(arready),
+        .axi_rdata(rdata),
+        .axi_rresp(rresp),
+        .axi_rvalid(rvalid),
+        .axi_rready(rready)
+    );
+
+//DMA STREAM, idle
+    assign SAMP_AXIS_tdata  = 32'd0;
+    assign SAMP_AXIS_tvalid = 1'b0;
+    assign SAMP_AXIS_aclk   = aclk;
+
+endmodule
@@ -0,0 +1,39 @@
+`timescale 1ns / 1ps
+//////////////////////////////////////////////////////////////////////////////////
+// Company:
+// Engineer:
+//
+// Create Date:
+// Design Name:
+// Module Name: vio_0
+// Project Name:
+// Target Devices:
+// Tool Versions:
+// Description: Simulation stand-in for the VIO debug core (Verilator only),
+//              the probes are left unconnected.
+//
+// Dependencies:
+//
+// Revision:
+// Revision 0.01 - File Created
+// Additional Comments:
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+
+module vio_0
+    (
+    input clk,
+    input [31:0] probe_in0,
+    input [31:0] probe_in1,
+    input [31:0] probe_in2,
+    input [31:0] probe_in3,
+    input [31:0] probe_in4,
+    input [31:0] probe_in5,
+    input [31:0] probe_in6,
+    input [31:0] probe_in7,
+    input [31:0] probe_in8,
+    input [31:0] probe_in9
+    );
+
+endmodule
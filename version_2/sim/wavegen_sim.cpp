@@ -0,0 +1,438 @@
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: any Linux host with Verilator 5 (no hardware required)
+
+// Cycle simulation of wavegen_system_top
+//   Clocks the Verilated design at 100 MHz, writes the AXI register map of
+//   kernel/wavegenIp_regs.h through the AXI master of the system_wrapper
+//   stand-in and decodes the SPI pins (CS_, CLK_SPI, SDI, LDAC_) back into
+//   DAC words, one sample of every channel per LDAC_ pulse.
+//   With -g the decoded words are compared with the golden model
+//   (kernel/wavegen_model.c) from the sample the channels were started on.
+//
+// Build:
+//   make [CHANNELS=n] [THREADS=n] [TRACE=1]
+// Run:
+//   ./obj_dir/wavegen_sim -t 0.1 -r 50000 -c 0,1,1000,16383,0 -c 1,3,250,8192,0 -o words.txt -g
+//     -t seconds      simulated time (default 0.01)
+//     -r rate         sample rate in Hz (SRAT)
+//     -c ch,mode,frequency,amplitude,offset
+//                     channel bank settings, amplitude and offset in Q14,
+//                     every configured channel is started together
+//     -w offset=value raw register write, word offset as in wavegenIp_regs.h
+//     -x              toggle the external trigger (GPIO[0]) every 1 ms
+//     -o file         decoded samples: <time ns> <word 0> .. <word n-1>
+//     -v file         VCD trace (TRACE=1 builds)
+//     -g              compare with the golden model
+//-----------------------------------------------------------------------------
+
+#include <stdlib.h>             // EXIT_ codes, strtoul
+#include <stdio.h>              // printf, fopen
+#include <stdint.h>             // C99 integer types -- uint32_t
+#include <unistd.h>             // getopt
+#include <time.h>               // clock_gettime
+#include <deque>                // AXI transfer queue
+#include <vector>               // decoded samples
+#include <memory>               // unique_ptr
+#include "verilated.h"
+#if VM_TRACE
+#include "verilated_vcd_c.h"
+#endif
+#include "Vwavegen_system_top.h"
+#include "Vwavegen_system_top__Dpi.h"
+#include "wavegenIp_regs.h"     // register map
+#include "wavegen_model.h"      // golden model
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+#ifndef WAVEGEN_CHANNELS
+#define WAVEGEN_CHANNELS 2
+#endif
+
+#define DACS (WAVEGEN_CHANNELS / 2)
+#define CLOCK_NS 10                 // CLK100 period
+#define ALIGN_SAMPLES 64            // Decoded samples searched for the model start
+#define MAX_MISMATCHES 10           // Mismatches printed by -g
+
+enum { AXI_NONE = 0, AXI_WRITE = 1, AXI_READ = 2 };
+
+typedef struct
+{
+    int kind;
+    uint32_t address;               // Byte address
+    uint32_t data;
+} AxiTransfer;
+
+// Transfers waiting for the AXI master of system_wrapper
+static std::deque<AxiTransfer> axiQueue;
+static bool axiBusy = false;
+static uint32_t axiData;
+
+// SPI decoder of one DAC
+typedef struct
+{
+    uint32_t shift;
+    uint32_t bits;
+    uint16_t word[2];               // DAC A, DAC B
+    bool lastCs;
+    bool lastSclk;
+} SpiDecoder;
+
+typedef struct
+{
+    uint64_t time;                  // ns, LDAC_ falling edge
+    uint16_t word[WAVEGEN_CHANNELS];
+} DacSample;
+
+static std::unique_ptr<VerilatedContext> context;
+static std::unique_ptr<Vwavegen_system_top> top;
+#if VM_TRACE
+static VerilatedVcdC *vcd = NULL;
+#endif
+static SpiDecoder decoder[DACS];
+static bool lastLdac = true;
+static std::vector<DacSample> samples;
+static uint64_t clocks = 0;
+static bool extToggle = false;
+
+//-----------------------------------------------------------------------------
+// DPI, called by the AXI master of system_wrapper on every idle AXI clock
+//-----------------------------------------------------------------------------
+
+int simAxiRequest(int *address, int *data)
+{
+    if (axiBusy || axiQueue.empty())
+        return AXI_NONE;
+
+    AxiTransfer transfer = axiQueue.front();
+    axiQueue.pop_front();
+    axiBusy = true;
+    *address = (int)transfer.address;
+    *data = (int)transfer.data;
+    return transfer.kind;
+}
+
+void simAxiResponse(int data)
+{
+    axiData = (uint32_t)data;
+    axiBusy = false;
+}
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+// Shifts SDI in on rising SCLK while CS_ is low, a 16 bit frame ends on CS_ high
+static void decodeSpi()
+{
+    bool sclk = top->CLK_SPI;
+    bool ldac = top->LDAC_;
+    DacSample sample;
+    uint32_t d;
+
+    for (d = 0; d < DACS; d++)
+    {
+        SpiDecoder *spi = &decoder[d];
+        bool cs = (top->CS_ >> d) & 1;
+
+        if (!cs && spi->lastCs)
+        {
+            spi->shift = 0;
+            spi->bits = 0;
+        }
+        if (!cs && sclk && !spi->lastSclk)
+        {
+            spi->shift = (spi->shift << 1) | ((top->SDI >> d) & 1);
+            spi->bits++;
+        }
+        if (cs && !spi->lastCs && spi->bits == 16)
+            spi->word[(spi->shift >> 15) & 1] = spi->shift & 0xFFF;     // Bit 15 selects DAC B
+
+        spi->lastCs = cs;
+        spi->lastSclk = sclk;
+    }
+
+    // Both outputs of every DAC update together
+    if (!ldac && lastLdac)
+    {
+        sample.time = clocks * CLOCK_NS;
+        for (d = 0; d < DACS; d++)
+        {
+            sample.word[2 * d] = decoder[d].word[0];
+            sample.word[2 * d + 1] = decoder[d].word[1];
+        }
+        samples.push_back(sample);
+    }
+    lastLdac = ldac;
+}
+
+// One CLK100 period, the PS clock of the stand-in runs with it
+static void tick()
+{
+    top->CLK100 = 1;
+    top->FIXED_IO_ps_clk = 1;
+    top->eval();
+    context->timeInc(CLOCK_NS / 2);
+#if VM_TRACE
+    if (vcd)    vcd->dump(context->time());
+#endif
+    decodeSpi();
+
+    top->CLK100 = 0;
+    top->FIXED_IO_ps_clk = 0;
+    top->eval();
+    context->timeInc(CLOCK_NS / 2);
+#if VM_TRACE
+    if (vcd)    vcd->dump(context->time());
+#endif
+    clocks++;
+}
+
+static void run(uint64_t count)
+{
+    while (count-- && !context->gotFinish())
+    {
+        // External trigger square wave, 1 ms high, 1 ms low
+        if (extToggle && clocks % 100000 == 0)
+            top->GPIO ^= 1;
+        tick();
+    }
+}
+
+static uint32_t transfer(int kind, uint32_t offset, uint32_t value)
+{
+    axiQueue.push_back({ kind, offset * 4, value });
+    while (!axiQueue.empty() || axiBusy)
+        tick();
+    return axiData;
+}
+
+static void writeRegister(uint32_t offset, uint32_t value)
+{
+    transfer(AXI_WRITE, offset, value);
+}
+
+static uint32_t readRegister(uint32_t offset)
+{
+    return transfer(AXI_READ, offset, 0);
+}
+
+// Model from the first sample of the started channels; the decoded stream
+// starts earlier, so the model is aligned on the first ALIGN_SAMPLES
+static int checkModel(WaveModel *model, size_t first)
+{
+    std::vector<DacSample> expected;
+    DacSample sample;
+    size_t start, i, n, mismatches = 0;
+    uint32_t c;
+
+    for (i = first; i < samples.size(); i++)
+    {
+        modelSample(model, sample.word);
+        expected.push_back(sample);
+    }
+
+    for (start = first; start < first + ALIGN_SAMPLES && start < samples.size(); start++)
+    {
+        for (n = 0; n < 8 && start + n < samples.size(); n++)
+        {
+            for (c = 0; c < WAVEGEN_CHANNELS; c++)
+            {
+                if (samples[start + n].word[c] != expected[n].word[c])
+                    break;
+            }
+            if (c != WAVEGEN_CHANNELS)
+                break;
+        }
+        if (n == 8)
+            break;
+    }
+    if (start == first + ALIGN_SAMPLES || start >= samples.size())
+    {
+        printf("model: no match in the first %u samples after the start\n", ALIGN_SAMPLES);
+        return EXIT_FAILURE;
+    }
+
+    for (i = start, n = 0; i < samples.size(); i++, n++)
+    {
+        for (c = 0; c < WAVEGEN_CHANNELS; c++)
+        {
+            if (samples[i].word[c] != expected[n].word[c])
+            {
+                if (mismatches < MAX_MISMATCHES)
+                    printf("sample %zu channel %u: rtl %03x, model %03x\n", n, c, samples[i].word[c], expected[n].word[c]);
+                mismatches++;
+            }
+        }
+    }
+
+    printf("model: %zu samples from sample %zu, %zu mismatched: %s\n",
+           n, start, mismatches, mismatches ? "failed" : "passed");
+    return mismatches ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+//-----------------------------------------------------------------------------
+// Main
+//-----------------------------------------------------------------------------
+
+int main(int argc, char* argv[])
+{
+    double seconds = 0.01;
+    uint32_t rate = 0, runMask = 0, c, ch, mode, frequency, offset, value;
+    uint32_t frequencies[WAVEGEN_CHANNELS] = { 0 };
+    int32_t amplitude, dcOffset;
+    const char *outPath = NULL, *vcdPath = NULL;
+    bool check = false, raw = false;
+    struct timespec start, end;
+    WaveModel model;
+    size_t first;
+    int option, result = EXIT_SUCCESS;
+
+    context.reset(new VerilatedContext);
+    context->commandArgs(argc, argv);
+    top.reset(new Vwavegen_system_top{context.get()});
+    modelInit(&model, WAVEGEN_CHANNELS);
+
+    // Registers are written after reset, the options are kept until then
+    std::vector<std::pair<uint32_t, uint32_t>> writes;
+
+    while ((option = getopt(argc, argv, "t:r:c:w:xo:v:g")) != -1)
+    {
+        switch (option)
+        {
+            case 't':
+                seconds = atof(optarg);
+                break;
+            case 'r':
+                rate = strtoul(optarg, NULL, 0);
+                writes.push_back({ OFS_SRATE, rate });
+                break;
+            case 'c':
+                if (sscanf(optarg, "%u,%u,%u,%d,%d", &ch, &mode, &frequency, &amplitude, &dcOffset) != 5 || ch >= WAVEGEN_CHANNELS)
+                {
+                    printf("-c %s: expected channel,mode,frequency,amplitude,offset\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                writes.push_back({ OFS_CH(ch, OFS_CH_CTRL), mode & CH_CTRL_MODE });
+                writes.push_back({ OFS_CH(ch, OFS_CH_FREQ), frequency });
+                writes.push_back({ OFS_CH(ch, OFS_CH_OFFSET), (uint16_t)dcOffset });
+                writes.push_back({ OFS_CH(ch, OFS_CH_AMPLITUDE), (uint16_t)amplitude });
+                model.ch[ch].mode = mode & CH_CTRL_MODE;
+                frequencies[ch] = frequency;
+                model.ch[ch].amplitude = (int16_t)amplitude;
+                model.ch[ch].offset = (int16_t)dcOffset;
+                runMask |= 1u << ch;
+                break;
+            case 'w':
+                if (sscanf(optarg, "%i=%i", &offset, &value) != 2)
+                {
+                    printf("-w %s: expected offset=value\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                writes.push_back({ offset, value });
+                raw = true;
+                break;
+            case 'x':
+                extToggle = true;
+                break;
+            case 'o':
+                outPath = optarg;
+                break;
+            case 'v':
+                vcdPath = optarg;
+                break;
+            case 'g':
+                check = true;
+                break;
+            default:
+                return EXIT_FAILURE;
+        }
+    }
+
+#if VM_TRACE
+    if (vcdPath)
+    {
+        context->traceEverOn(true);
+        vcd = new VerilatedVcdC;
+        top->trace(vcd, 99);
+        vcd->open(vcdPath);
+    }
+#else
+    if (vcdPath)
+        printf("-v: rebuild with make TRACE=1\n");
+#endif
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    // Reset of the AXI stand-in, then the IP registers
+    top->GPIO = 0;
+    run(32);
+    printf("IP channels: %u\n", readRegister(OFS_CHANNELS));
+    for (auto &write : writes)
+        writeRegister(write.first, write.second);
+
+    // New phase steps are published within a sample, start every channel on
+    // the same pulse once they are
+    run(2 * 2 * (modelSampleLoad(rate) + 1));
+    first = samples.size();
+    if (runMask)
+        writeRegister(OFS_RUN_MASK, runMask);
+
+    run((uint64_t)(seconds * 1e9 / CLOCK_NS));
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double wall = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) * 1e-9;
+    double simulated = clocks * CLOCK_NS * 1e-9;
+
+    printf("%llu clocks (%.3f s simulated) in %.3f s: %.2f M clocks/s, %.3f x real time\n",
+           (unsigned long long)clocks, simulated, wall, clocks / wall * 1e-6, simulated / wall);
+    if (samples.size() > first + 1)
+        printf("%zu DAC updates, %.1f samples/s\n", samples.size(),
+               (samples.size() - first - 1) * 1e9 / (samples.back().time - samples[first].time));
+
+    if (outPath)
+    {
+        FILE *file = fopen(outPath, "w");
+        if (file == NULL)
+        {
+            printf("%s: cannot create\n", outPath);
+            return EXIT_FAILURE;
+        }
+        for (auto &sample : samples)
+        {
+            fprintf(file, "%llu", (unsigned long long)sample.time);
+            for (c = 0; c < WAVEGEN_CHANNELS; c++)
+                fprintf(file, " %u", sample.word[c]);
+            fprintf(file, "\n");
+        }
+        fclose(file);
+    }
+
+    if (check)
+    {
+        if (raw)
+        {
+            printf("model: -w writes are not modelled, no check\n");
+        }
+        else
+        {
+            for (c = 0; c < WAVEGEN_CHANNELS; c++)
+            {
+                model.ch[c].deltaPhase = modelDeltaPhase(frequencies[c], rate);
+                model.ch[c].run = (runMask >> c) & 1;
+            }
+            result = checkModel(&model, first);
+        }
+    }
+
+#if VM_TRACE
+    if (vcd)
+        vcd->close();
+#endif
+    top->final();
+    return result;
+}
@@ -0,0 +1,77 @@
+`timescale 1ns / 1ps
+//////////////////////////////////////////////////////////////////////////////////
+// Company:
+// Engineer:
+//
+// Create Date:
+// Design Name:
+// Module Name: xpm_fifo_async
+// Project Name:
+// Target Devices:
+// Tool Versions:
+// Description: Simulation stand-in for the Xilinx asynchronous FIFO macro
+//              (Verilator only), first word fall through as used by streamIn.
+//
+// Dependencies:
+//
+// Revision:
+// Revision 0.01 - File Created
+// Additional Comments:
+//   The pointers are compared directly, which is only valid because the
+//   simulation runs wr_clk and rd_clk from one clock; FIFO_MEMORY_TYPE,
+//   FIFO_READ_LATENCY and CDC_SYNC_STAGES are ignored.
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+
+module xpm_fifo_async #
+    (
+        parameter FIFO_MEMORY_TYPE = "auto",
+        parameter integer FIFO_WRITE_DEPTH = 2048,      // Words, power of 2
+        parameter integer WRITE_DATA_WIDTH = 32,
+        parameter integer READ_DATA_WIDTH = 32,
+        parameter READ_MODE = "fwft",
+        parameter integer FIFO_READ_LATENCY = 0,
+        parameter integer CDC_SYNC_STAGES = 2,
+        localparam integer ADDR_BITS = $clog2(FIFO_WRITE_DEPTH)
+    )
+    (
+    input rst,
+    input wr_clk,
+    input wr_en,
+    input [WRITE_DATA_WIDTH-1:0] din,
+    output full,
+    input rd_clk,
+    input rd_en,
+    output [READ_DATA_WIDTH-1:0] dout,
+    output empty,
+    input sleep,
+    input injectsbiterr,
+    input injectdbiterr
+    );
+
+    reg [WRITE_DATA_WIDTH-1:0] fifo_R [0:FIFO_WRITE_DEPTH-1];
+    reg [ADDR_BITS:0] wr_ptr = 0;                       // Extra bit tells full from empty
+    reg [ADDR_BITS:0] rd_ptr = 0;
+
+    assign full  = (wr_ptr[ADDR_BITS] != rd_ptr[ADDR_BITS]) && (wr_ptr[ADDR_BITS-1:0] == rd_ptr[ADDR_BITS-1:0]);
+    assign empty = (wr_ptr == rd_ptr);
+    assign dout  = fifo_R[rd_ptr[ADDR_BITS-1:0]];
+
+    always_ff @(posedge wr_clk) begin
+        if (rst)
+            wr_ptr <= 0;
+        else if (wr_en && !full) begin
+            fifo_R[wr_ptr[ADDR_BITS-1:0]] <= din;
+            wr_ptr <= wr_ptr + 1;
+        end
+    end
+
+    always_ff @(posedge rd_clk) begin
+        if (rst)
+            rd_ptr <= 0;
+        else if (rd_en && !empty)
+            rd_ptr <= rd_ptr + 1;
+    end
+
+endmodule
@@ -0,0 +1,111 @@
+`timescale 1ns / 1ps
+//////////////////////////////////////////////////////////////////////////////////
+// Company:
+// Engineer:
+//
+// Create Date:
+// Design Name:
+// Module Name: sineLut
+// Project Name:
+// Target Devices:
+// Tool Versions:
+// Description: Sine of a 32 bit phase word, or the Hilbert transform of the
+//              triangle, from a quarter wave table.
+//              The two table entries around the phase are read on the two
+//              ports of one block RAM, folded onto the full wave by symmetry
+//              and linearly interpolated with the phase bits below the table
+//              index (replaces the full wave blk_mem_gen_1 table, which used
+//              four times the block RAM and dropped those bits).
+//
+// Dependencies:
+//
+// Revision:
+// Revision 0.01 - File Created
+// Revision 0.02 - Hilbert transform of the triangle in the same block RAM
+// Additional Comments:
+//   Entry i holds 16383 * sin(2 pi (i + 0.5) / 4096), i = 0..1023, so the
+//   second, third and fourth quarter are the first one mirrored and negated
+//   with no special case at the quarter boundaries.
+//   Entry 1024 + i holds the Hilbert transform of the samplePipeline
+//   triangle (-1 at phase 0, +1 at half period) at the same phase,
+//   -(8 / pi^2) * sum over odd n of sin(n x) / n^2, which has the same
+//   symmetry. The sum converges slowly, so it is integrated from its
+//   derivative -(1/2) ln tan(x/2): the ln(x/2) part exactly, the smooth
+//   rest ln(tan(x/2) / (x/2)) by the midpoint rule.
+//   Worst case error of the sine is below 1 LSB of Q14 (about 25 LSB for
+//   the full table without interpolation).
+//   sample is valid LATENCY clocks after phase.
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+
+module sineLut #
+    (
+        parameter integer LATENCY = 2,                  // Clocks from phase to sample, 2 or more
+        parameter integer FRAC_BITS = 12                // Phase bits used to interpolate
+    )
+    (
+    input clk,
+    input [31:0] phase,                                 // 0 to 2^32 is one period
+    input select,                                       // 0 = sine, 1 = Hilbert transform of the triangle
+    output signed [15:0] sample                         // Q14
+    );
+
+    localparam real PI = 3.14159265358979323846;
+
+//QUARTER WAVE TABLES, one RAMB36
+    (* rom_style = "block" *) reg signed [15:0] table_R [0:2047];
+    integer i;
+    real x, t, last, smooth;
+
+    initial begin
+        last   = 0.0;
+        smooth = 0.0;
+        for (i = 0; i < 1024; i = i + 1) begin
+            x = 2.0 * PI * (i + 0.5) / 4096.0;
+            table_R[i] = $rtoi(16383.0 * $sin(x) + 0.5);
+
+            t      = (last + x) / 2.0;
+            smooth = smooth + (x - last) * $ln($tan(t / 2.0) / (t / 2.0));
+            last   = x;
+            table_R[1024 + i] = -$rtoi(16383.0 * 4.0 / (PI * PI) * (x - x * $ln(x / 2.0) - smooth) + 0.5);
+        end
+    end
+
+//FOLD both neighbours onto the quarter
+    wire [31:0] phase_c = phase - 32'h00080000;         // Entries sit half a step after their index
+    wire [11:0] k0      = phase_c[31:20];
+    wire [11:0] k1      = k0 + 12'd1;
+    wire [9:0]  addr0   = k0[10] ? ~k0[9:0] : k0[9:0];  // Quarters 1 and 3 run backwards
+    wire [9:0]  addr1   = k1[10] ? ~k1[9:0] : k1[9:0];
+
+    reg signed [15:0] data0, data1;
+    reg neg0, neg1;                                     // Quarters 2 and 3 are negative
+    reg [FRAC_BITS-1:0] frac;
+
+    always_ff @(posedge clk) begin
+        data0 <= table_R[{select, addr0}];
+        data1 <= table_R[{select, addr1}];
+        neg0  <= k0[11];
+        neg1  <= k1[11];
+        frac  <= phase_c[19 -: FRAC_BITS];
+    end
+
+//INTERPOLATE, s0 + (s1 - s0) * frac, rounded
+    wire signed [16:0] s0    = neg0 ? -data0 : data0;
+    wire signed [16:0] s1    = neg1 ? -data1 : data1;
+    wire signed [17:0] diff  = s1 - s0;
+    wire signed [FRAC_BITS+18:0] slope = diff * $signed({1'b0, frac}) + (1 << (FRAC_BITS - 1));
+
+    reg signed [15:0] sample_R [0:LATENCY - 2];
+    integer j;
+
+    always_ff @(posedge clk) begin
+        sample_R[0] <= s0 + (slope >>> FRAC_BITS);
+        for (j = 1; j < LATENCY - 1; j = j + 1)
+            sample_R[j] <= sample_R[j - 1];
+    end
+
+    assign sample = sample_R[LATENCY - 2];
+
+endmodule
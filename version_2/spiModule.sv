@@ -9,109 +9,147 @@
 // Project Name:
 // Target Devices:
 // Tool Versions:
-// Description:
+// Description: SPI engine for the dual 12 bit DAC (frame A, frame B, LDAC pulse).
+//              Everything runs on clk; SCLK is a registered output toggled on a
+//              clock enable every SCLK_DIV clocks, so no fabric clock is made.
+//              A sample pair is latched on load and shifted out while the
+//              generators compute the next one; a load during a transfer is
+//              held and sent right after, so the update rate is set by the
+//              DAC timing rather than by the sampling pulse.
 //
 // Dependencies:
 //
 // Revision:
 // Revision 0.01 - File Created
+// Revision 0.02 - Clock enable, double buffered sample pair
 // Additional Comments:
+//   Default timing at clk = 100 MHz: SCLK = 100 / (2 * 3) = 16.7 MHz (DAC max 20 MHz),
+//   one update (2 x 16 bits + CS and LDAC) takes about 2.2 us.
+//   Feed clk from an MMCM output (e.g. 120 MHz with SCLK_DIV 3 = 20 MHz) to
+//   run the DAC at its exact maximum SCLK.
 //
 //////////////////////////////////////////////////////////////////////////////////
 
 
-module spiModule(
-    input clk,  // Get the Spi clocks from inside this module
-    input clk_spi,
+module spiModule #
+    (
+        parameter integer SCLK_DIV    = 3,              // clk cycles per SCLK half period
+        parameter integer CS_HIGH     = 4,              // clk cycles CS_ stays high between frames
+        parameter integer LDAC_LOW    = 12              // clk cycles of the LDAC_ pulse (>= 100 ns)
+    )
+    (
+    input clk,
+    input load,                 // One clk pulse: latch a new sample pair
     input reg[11:0] dacA_in,
     input reg[11:0] dacB_in,
 
-    output reg chipselect,     // Connect these to the actual registers in the top module using wires
-    // output reg clk_spi,
-    output reg sdi,
-    output reg ldac
+    output reg chipselect = 1'b1,
+    output reg sclk = 1'b0,
+    output reg sdi = 1'b0,
+    output reg ldac = 1'b1,
+    output reg busy = 1'b0      // Transfer in progress
     );
 
+    localparam integer IDLE = 0, SHIFT = 1, GAP = 2, LDAC = 3;
 
- 
+    reg [1:0] state = IDLE;
+    reg [15:0] shift;           // Frame being shifted, MSB first
+    reg [15:0] frameB;          // Second frame of the transfer
+    reg frame = 1'b0;           // 0 = frame A, 1 = frame B
+    reg [4:0] bits;             // Bits left in the frame
+    reg [7:0] wait_count;       // clk cycles left in the current phase
 
-    // Idle , Start SPI, write 16 bits, End SPI, Start SPI, write 16 bits, End SPI, Pulse LDAC
-    reg [7:0]state = 8'd0;      // ranges from 0 to 40
-    reg [7:0]index = 8'd15;
-    reg sentFrame  = 1'b0;
-    reg firstFrame = 1'b1;      // This will only be true for the first frame and false for the rest
+    // Double buffer: the pair waiting for the shifter
+    reg [11:0] pendingA, pendingB;
+    reg pending = 1'b0;
 
-    reg [15:0]dacA;
-    reg [15:0]dacB;
-
-    // wire [11:0]dacA_signal;
-    // wire [11:0]dacB_signal;
+    always_ff @(posedge clk) begin
+        if (load) begin
+            pendingA <= dacA_in;
+            pendingB <= dacB_in;
+            pending  <= 1'b1;
+        end
 
-    // wire dacA_load;
-    // wire dacB_load;
+        case (state)
+            IDLE:
+            begin
+                ldac <= 1'b1;
+                if (pending && !load) begin
+                    // Start frame A, first bit is set up before the first rising SCLK edge
+                    shift      <= {4'b0011, pendingA} << 1;
+                    sdi        <= 1'b0;                 // MSB of 4'b0011
+                    frameB     <= {4'b1011, pendingB};
+                    pending    <= 1'b0;
+                    frame      <= 1'b0;
+                    bits       <= 5'd16;
+                    wait_count <= SCLK_DIV - 1;
+                    chipselect <= 1'b0;
+                    busy       <= 1'b1;
+                    state      <= SHIFT;
+                end
+                else begin
+                    busy       <= 1'b0;
+                end
+            end
 
-       always_ff@(posedge clk) begin
-    // Get the data bits to be sent from SW[9:0] + PB[3:2] temporarily to get the 12 bits
-     dacA <= {4'b0011, dacA_in};
-     dacB <= {4'b1011, dacB_in};
-    
-    end
+            SHIFT:
+            begin
+                if (wait_count != 0) begin
+                    wait_count <= wait_count - 1;
+                end
+                else begin
+                    wait_count <= SCLK_DIV - 1;
+                    sclk       <= ~sclk;
+                    if (sclk) begin
+                        // Falling edge: next bit, or end of frame after the 16th
+                        if (bits == 5'd1) begin
+                            chipselect <= 1'b1;
+                            wait_count <= CS_HIGH - 1;
+                            state      <= GAP;
+                        end
+                        else begin
+                            sdi   <= shift[15];
+                            shift <= shift << 1;
+                        end
+                        bits <= bits - 1;
+                    end
+                end
+            end
 
-    always_ff @(negedge clk_spi) begin
-        if (state == 0) begin
-            // SPI frame A
-            chipselect <= 1'b0; // State 0: CS_ goes low and first bit of data is sampled
-            sdi <= dacA[index]; // Assign the most significant bit of dacA
-            state <= state + 1;
-            index <= index -1;
-        end else if (state >= 1 && state <= 15) begin
-            // State 1-15: Write data from dacA bit by bit to GPIO_18
-            sdi <= dacA[index]; // Assign the most significant bit of dacA
-            index <= index -1;
-            state <= state + 1;
-        end else if (state == 16) begin
-            chipselect <= 1'b1; // State 16: CS_ goes high
-            state <= state + 1;
-            index <= 8'd15;
-        end
-            // SPI frame B
-        else if (state == 17) begin
-            chipselect <= 1'b0; // State 17: CS_ goes low
-            sdi <= dacB[index]; // Assign the most significant bit of dacA
-            state <= state + 1;
-            index <= index -1;
-        end else if (state >= 18 && state <= 32) begin
-            // State 20-36: Write data from dacB bit by bit to GPIO_18
-            sdi <= dacB[index]; // Assign the most significant bit of dacB
-            index <= index -1;
-            state <= state + 1;
-        end else if (state == 33) begin
-            chipselect <= 1; // State 33: CS_ goes high
-            state <= state + 1;
-            index <= 8'd15;
-        end
-            //LDAC pulse
-        else if (state == 34) begin
-            ldac <= 1; // State 34: LDAC_ goes high
-            state <= state + 1;
-        end else if (state == 35) begin
-            ldac <= 0; // State 35: LDAC_ goes low
-            state <= state + 1;
-            sentFrame <= 1'b1; // Sent One complete frame (A + B)
-            firstFrame <= 1'b0;
-        end
-        // Loopback at 50Khz rate. This is controlled by another always bloack at 50Khz rate
-        else begin
-            if(state == 40) begin
-                state <= 8'd0;
-                sentFrame <= 1'b0;      // Mark the upcoming new frame as unsent
+            GAP:
+            begin
+                if (wait_count != 0) begin
+                    wait_count <= wait_count - 1;
+                end
+                else if (!frame) begin
+                    // Frame B
+                    shift      <= frameB << 1;
+                    sdi        <= frameB[15];
+                    frame      <= 1'b1;
+                    bits       <= 5'd16;
+                    wait_count <= SCLK_DIV - 1;
+                    chipselect <= 1'b0;
+                    state      <= SHIFT;
+                end
+                else begin
+                    // Both frames in, update both outputs together
+                    ldac       <= 1'b0;
+                    wait_count <= LDAC_LOW - 1;
+                    state      <= LDAC;
+                end
             end
-            else begin
-            state <= state +1;
+
+            LDAC:
+            begin
+                if (wait_count != 0) begin
+                    wait_count <= wait_count - 1;
+                end
+                else begin
+                    ldac  <= 1'b1;
+                    state <= IDLE;
+                end
             end
-        end
+        endcase
     end
 
-
-
-endmodule
\ No newline at end of file
+endmodule
@@ -0,0 +1,113 @@
+`timescale 1ns / 1ps
+//////////////////////////////////////////////////////////////////////////////////
+// Company:
+// Engineer:
+//
+// Create Date:
+// Design Name:
+// Module Name: stepCalc
+// Project Name:
+// Target Devices:
+// Tool Versions:
+// Description: Computes the sampling clock count and the phase steps once per
+//              register write. When the sample rate or a frequency changes,
+//              the divisions below are run one after the other on a single
+//              seqDivider and the results are latched together, so the mode
+//              select logic only reads registers on the sampling pulse.
+//
+// Dependencies: seqDivider
+//
+// Revision:
+// Revision 0.01 - File Created
+// Revision 0.02 - Phase steps only, every shape runs from one phase word
+// Revision 0.03 - One phase step per channel
+// Additional Comments:
+//   About (CHANNELS + 1) x 65 clocks (2 us at 100 MHz for 2 channels) from a
+//   register write to new step values; the previous values are used until then.
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+
+module stepCalc #
+    (
+        parameter integer CHANNELS = 2
+    )
+    (
+    input clk,
+
+    input [31:0] srate,                                 // Sample rate (Hz)
+    input [CHANNELS*32-1:0] freq,                       // Frequencies (Hz), channel n in bits [n*32 +: 32]
+
+    output reg [15:0] sampleLoad = 16'd1000,            // Sampling clock toggle count, 50000000 / srate
+    output reg [CHANNELS*32-1:0] deltaPhase,            // Phase steps, freq * 2^32 / srate
+    output reg busy = 1'b0                              // New step values being computed
+    );
+
+    localparam integer STEPS = CHANNELS + 1;            // Sampling clock, then one step per channel
+    localparam integer STEP_BITS = $clog2(STEPS);
+
+    // Inputs the current results were computed from
+    reg [31:0] srate_S = 32'd0;
+    reg [CHANNELS*32-1:0] freq_S = 0;
+
+    reg [STEP_BITS-1:0] step;
+    reg publish = 1'b0;
+    reg [63:0] result [0:STEPS-1];
+    integer i;
+
+    reg div_start = 1'b0;
+    reg [63:0] div_dividend;
+    reg [31:0] div_divisor;
+    wire [63:0] div_quotient;
+    wire div_done;
+
+    seqDivider #(.WIDTH(64)) divider (
+        .clk(clk),
+        .start(div_start),
+        .dividend(div_dividend),
+        .divisor(div_divisor),
+        .quotient(div_quotient),
+        .done(div_done)
+    );
+
+    // Operands of each step
+    always_comb begin
+        div_divisor = srate_S;
+        if (step == 0)  div_dividend = 64'd50000000;
+        else            div_dividend = freq_S[(step - 1)*32 +: 32] * 64'hFFFFFFFF;
+    end
+
+    always_ff @(posedge clk) begin
+        div_start <= 1'b0;
+        publish   <= 1'b0;
+
+        if (publish) begin
+            // Publish every step value at once
+            sampleLoad <= result[0][15:0];
+            for (i = 0; i < CHANNELS; i = i + 1)
+                deltaPhase[i*32 +: 32] <= result[i + 1][31:0];
+            busy <= 1'b0;
+        end
+        else if (!busy) begin
+            if (srate != srate_S || freq != freq_S) begin
+                srate_S   <= srate;
+                freq_S    <= freq;
+                step      <= 0;
+                div_start <= 1'b1;
+                busy      <= 1'b1;
+            end
+        end
+        else if (div_done) begin
+            result[step] <= div_quotient;
+
+            if (step != STEPS - 1) begin
+                step      <= step + 1;
+                div_start <= 1'b1;
+            end
+            else begin
+                publish   <= 1'b1;
+            end
+        end
+    end
+
+endmodule
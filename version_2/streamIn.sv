@@ -0,0 +1,92 @@
+`timescale 1ns / 1ps
+//////////////////////////////////////////////////////////////////////////////////
+// Company:
+// Engineer:
+//
+// Create Date:
+// Design Name:
+// Module Name: streamIn
+// Project Name:
+// Target Devices:
+// Tool Versions:
+// Description: AXI-Stream sample input fed by the AXI DMA MM2S channel.
+//              Words are buffered in an asynchronous FIFO (DMA clock to clk)
+//              and one word is played per sampling pulse while enabled.
+//              The last word is held when the FIFO runs empty.
+//
+// Dependencies: xpm_fifo_async (Xilinx parameterized macros)
+//
+// Revision:
+// Revision 0.01 - File Created
+// Additional Comments:
+//   Stream word:
+//     [27:16] DAC B word (already calibrated, 0-4095)
+//     [11:0]  DAC A word (already calibrated, 0-4095)
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+
+module streamIn #
+    (
+        parameter integer FIFO_DEPTH = 2048             // Words, power of 2
+    )
+    (
+    input clk,
+    input clk_sampling,
+    input enable,                                       // Either channel in stream mode
+
+    input s_axis_aclk,
+    input [31:0] s_axis_tdata,
+    input s_axis_tvalid,
+    output s_axis_tready,
+
+    output reg underflow,                               // FIFO was empty at a sampling pulse
+
+    output reg  [11:0] dacA_strm_fin,
+    output reg  [11:0] dacB_strm_fin
+    );
+
+    wire [31:0] fifo_dout;
+    wire fifo_full;
+    wire fifo_empty;
+    wire fifo_rd_en = clk_sampling && enable && !fifo_empty;
+
+    assign s_axis_tready = !fifo_full;
+
+    xpm_fifo_async #(
+        .FIFO_MEMORY_TYPE("block"),
+        .FIFO_WRITE_DEPTH(FIFO_DEPTH),
+        .WRITE_DATA_WIDTH(32),
+        .READ_DATA_WIDTH(32),
+        .READ_MODE("fwft"),                             // dout valid while !empty
+        .FIFO_READ_LATENCY(0),
+        .CDC_SYNC_STAGES(2)
+    ) sample_fifo (
+        .rst(1'b0),
+        .wr_clk(s_axis_aclk),
+        .wr_en(s_axis_tvalid && !fifo_full),
+        .din(s_axis_tdata),
+        .full(fifo_full),
+        .rd_clk(clk),
+        .rd_en(fifo_rd_en),
+        .dout(fifo_dout),
+        .empty(fifo_empty),
+        .sleep(1'b0),
+        .injectsbiterr(1'b0),
+        .injectdbiterr(1'b0)
+    );
+
+    always_ff @(posedge clk) begin
+        if (clk_sampling && enable) begin
+            if (!fifo_empty) begin
+                dacA_strm_fin <= fifo_dout[11:00];
+                dacB_strm_fin <= fifo_dout[27:16];
+                underflow     <= 1'b0;
+            end
+            else begin
+                underflow     <= 1'b1;                  // Hold the last word
+            end
+        end
+    end
+
+endmodule
@@ -4,6 +4,7 @@
 	module wavegen_soc_v1_0 #
 	(
 		// Users to add parameters here
+		parameter integer CHANNELS	= 2,
 
 		// User parameters ends
 		// Do not modify the parameters beyond this line
@@ -11,18 +12,27 @@
 
 		// Parameters of Axi Slave Bus Interface AXI
 		parameter integer C_AXI_DATA_WIDTH	= 32,
-		parameter integer C_AXI_ADDR_WIDTH	= 5
+		parameter integer C_AXI_ADDR_WIDTH	= 16
 	)
 	(
 		// Users to add ports here
-		output wire [31:00] mode_W_O,               // Mode Wire Output
-        output wire [31:00] runn_W_O,               // Run Wire Output
-        output wire [31:00] frqA_W_O,               // Frequency A Wire Output
-        output wire [31:00] frqB_W_O,               // Frequency B Wire Output
-        output wire [31:00] ofst_W_O,               // Offset Wire Output
-        output wire [31:00] ampl_W_O,               // Amplitude Wire Output
-        output wire [31:00] dCyc_W_O,               // Duty Cycels Wire Output
-        output wire [31:00] cycl_W_O,               // Cycles Wire Output
+		output wire [CHANNELS*3-1:0] mode_W_O,      // Mode Wire Output
+        output wire [CHANNELS-1:0] runn_W_O,        // Run Wire Output
+        output wire [CHANNELS-1:0] hilb_W_O,        // Hilbert Wire Output
+        output wire [CHANNELS-1:0] comp_W_O,        // Complement Wire Output
+        output wire [CHANNELS*32-1:0] freq_W_O,     // Frequency Wire Output
+        output wire [CHANNELS*16-1:0] ofst_W_O,     // Offset Wire Output
+        output wire [CHANNELS*16-1:0] ampl_W_O,     // Amplitude Wire Output
+        output wire [CHANNELS*16-1:0] dCyc_W_O,     // Duty Cycels Wire Output
+        output wire [CHANNELS*16-1:0] cycl_W_O,     // Cycles Wire Output
+        output wire [CHANNELS*16-1:0] phas_W_O,     // Phase Offset Wire Output
+        output wire [31:00] srat_W_O,               // Sample Rate Wire Output
+        output wire [31:00] arbw_W_O,               // Arbitrary Sample Write Wire Output
+        output wire arbc_W_O,                       // Arbitrary Sample Write Clock Output
+        output wire [CHANNELS-1:0] trig_W_O,        // Burst Trigger Wire Output
+        output wire [CHANNELS-1:0] trgx_W_O,        // External Trigger Enable Wire Output
+        input wire [CHANNELS-1:0] bdon_W_I,         // Burst Done Wire Input
+        output wire irq,                            // Burst done interrupt, active high
 		// User ports ends
 		// Do not modify the ports beyond this line
 
@@ -52,6 +62,7 @@
 	);
 // Instantiation of Axi Bus Interface AXI
 	wavegen_soc_v1_0_AXI # ( 
+		.CHANNELS(CHANNELS),
 		.C_S_AXI_ADDR_WIDTH(C_AXI_ADDR_WIDTH)
 	) wavegen_soc_v1_0_AXI_inst (
 		.S_AXI_ACLK(axi_aclk),
@@ -77,12 +88,21 @@
 		.S_AXI_RREADY(axi_rready),
         .mode_W_O(mode_W_O),
 		.runn_W_O(runn_W_O),
-		.frqA_W_O(frqA_W_O),
-		.frqB_W_O(frqB_W_O),
+		.hilb_W_O(hilb_W_O),
+		.comp_W_O(comp_W_O),
+		.freq_W_O(freq_W_O),
 		.ofst_W_O(ofst_W_O),
 		.ampl_W_O(ampl_W_O),
 		.dCyc_W_O(dCyc_W_O),
-		.cycl_W_O(cycl_W_O)
+		.cycl_W_O(cycl_W_O),
+		.phas_W_O(phas_W_O),
+		.srat_W_O(srat_W_O),
+		.arbw_W_O(arbw_W_O),
+		.arbc_W_O(arbc_W_O),
+		.trig_W_O(trig_W_O),
+		.trgx_W_O(trgx_W_O),
+		.bdon_W_I(bdon_W_I),
+		.irq(irq)
 	);
 
 	// Add user logic here
@@ -3,19 +3,31 @@
 
 module wavegen_soc_v1_0_AXI #
 	(
-		// Bit width of S_AXI address bus
-        parameter integer C_S_AXI_ADDR_WIDTH = 5
+		// Generator channels, one register bank and one sample table each (2 to 14)
+        parameter integer CHANNELS = 2,
+		// Bit width of S_AXI address bus, covers (CHANNELS + 2) 4 KiB blocks
+        parameter integer C_S_AXI_ADDR_WIDTH = 16
     )
     (
         // Ports to top level module (what makes this the register IP module)
-        output wire [31:00] mode_W_O,               // Mode Wire Output
-        output wire [31:00] runn_W_O,               // Run Wire Output
-        output wire [31:00] frqA_W_O,               // Frequency A Wire Output
-        output wire [31:00] frqB_W_O,               // Frequency B Wire Output
-        output wire [31:00] ofst_W_O,               // Offset Wire Output
-        output wire [31:00] ampl_W_O,               // Amplitude Wire Output
-        output wire [31:00] dCyc_W_O,               // Duty Cycels Wire Output
-        output wire [31:00] cycl_W_O,               // Cycles Wire Output
+        // Channel n of a packed output is in bits [n*width +: width]
+        output wire [CHANNELS*3-1:0] mode_W_O,      // Mode Wire Output
+        output wire [CHANNELS-1:0] runn_W_O,        // Run Wire Output
+        output wire [CHANNELS-1:0] hilb_W_O,        // Hilbert Wire Output
+        output wire [CHANNELS-1:0] comp_W_O,        // Complement Wire Output
+        output wire [CHANNELS*32-1:0] freq_W_O,     // Frequency Wire Output
+        output wire [CHANNELS*16-1:0] ofst_W_O,     // Offset Wire Output
+        output wire [CHANNELS*16-1:0] ampl_W_O,     // Amplitude Wire Output
+        output wire [CHANNELS*16-1:0] dCyc_W_O,     // Duty Cycels Wire Output
+        output wire [CHANNELS*16-1:0] cycl_W_O,     // Cycles Wire Output
+        output wire [CHANNELS*16-1:0] phas_W_O,     // Phase Offset Wire Output
+        output wire [31:00] srat_W_O,               // Sample Rate Wire Output
+        output wire [31:00] arbw_W_O,               // Arbitrary Sample Write Wire Output
+        output wire arbc_W_O,                       // Arbitrary Sample Write Clock Output
+        output wire [CHANNELS-1:0] trig_W_O,        // Burst Trigger Wire Output, toggles once per software trigger
+        output wire [CHANNELS-1:0] trgx_W_O,        // External Trigger Enable Wire Output
+        input wire [CHANNELS-1:0] bdon_W_I,         // Burst Done Wire Input, toggles once per finished burst
+        output wire irq,                            // High while a burst done bit is set
 
         input wire S_AXI_ACLK,                      // AXI Clock
         input wire S_AXI_ARESETN,                   // AXI reset
@@ -53,25 +65,54 @@ module wavegen_soc_v1_0_AXI #
         input wire S_AXI_RREADY
     );
 
-    // Internal registers
-    reg [31:0] mode_R_I_WR;                         // Mode                 Register Internal Write/Read
-    reg [31:0] runn_R_I_WR;                         // Run                  Register Internal Write/Read
-    reg [31:0] frqA_R_I_WR;                         // Frequency Channel A  Register Internal Write/Read
-    reg [31:0] frqB_R_I_WR;                         // Frequency Channel B  Register Internal Write/Read
-    reg [31:0] ofst_R_I_WR;                         // Offset               Register Internal Write/Read
-    reg [31:0] ampl_R_I_WR;                         // Amplitude            Register Internal Write/Read
-    reg [31:0] dCyc_R_I_WR;                         // Duty Cycle           Register Internal Write/Read
-    reg [31:0] cycl_R_I_WR;                         // Cycles               Register Internal Write/Read
-
-    // Register numbers
-    localparam integer MODE_REG_P = 3'b000;         // Register to hold mode value
-    localparam integer RUN__REG_P = 3'b001;         // Register to hold run value
-    localparam integer FRQA_REG_P = 3'b010;         // Register to hold frequency Ch A value
-    localparam integer FRQB_REG_P = 3'b011;         // Register to hold frequency Ch A value
-    localparam integer OFST_REG_P = 3'b100;         // Register to hold offset value
-    localparam integer AMPL_REG_P = 3'b101;         // Register to hold amplitude value
-    localparam integer DCYC_REG_P = 3'b110;         // Register to hold duty cycle value
-    localparam integer CYCL_REG_P = 3'b111;         // Register to hold cycles value
+    // Internal registers, one per channel
+    reg [4:0]  ctrl_R_I_WR [0:CHANNELS-1];          // Mode (2:0), hilbert (3), complement (4)
+    reg [31:0] freq_R_I_WR [0:CHANNELS-1];          // Frequency            Register Internal Write/Read
+    reg [15:0] ofst_R_I_WR [0:CHANNELS-1];          // Offset               Register Internal Write/Read
+    reg [15:0] ampl_R_I_WR [0:CHANNELS-1];          // Amplitude            Register Internal Write/Read
+    reg [15:0] dCyc_R_I_WR [0:CHANNELS-1];          // Duty Cycle           Register Internal Write/Read
+    reg [15:0] cycl_R_I_WR [0:CHANNELS-1];          // Cycles               Register Internal Write/Read
+    reg [15:0] phas_R_I_WR [0:CHANNELS-1];          // Phase Offset         Register Internal Write/Read
+    reg [CHANNELS-1:0] runn_R_I_WR;                 // Run, one bit per channel
+    reg [31:0] srat_R_I_WR;                         // Sample Rate          Register Internal Write/Read
+    reg [CHANNELS-1:0] trig_R_I_W;                  // Software trigger toggles
+    reg [CHANNELS-1:0] trgx_R_I_WR;                 // External trigger enable, one bit per channel
+    reg [CHANNELS-1:0] bdon_R_I_R;                  // Burst done, one bit per channel, write 1 to clear
+
+    // Address blocks of 4 KiB (address bits 15:12)
+    localparam integer GLOB_BLOCK = 0;              // Global registers
+    localparam integer BANK_BLOCK = 1;              // Channel register banks
+    localparam integer ARB_BLOCK  = 2;              // Sample table of channel 0, one block per channel
+
+    // Global register numbers, 0 to 7 pack channel 0 and 1 the way the two channel IP did
+    localparam integer MODE_REG_P = 4'b0000;        // Register to hold mode value
+    localparam integer RUN__REG_P = 4'b0001;        // Register to hold run value
+    localparam integer FRQA_REG_P = 4'b0010;        // Register to hold frequency Ch A value
+    localparam integer FRQB_REG_P = 4'b0011;        // Register to hold frequency Ch A value
+    localparam integer OFST_REG_P = 4'b0100;        // Register to hold offset value
+    localparam integer AMPL_REG_P = 4'b0101;        // Register to hold amplitude value
+    localparam integer DCYC_REG_P = 4'b0110;        // Register to hold duty cycle value
+    localparam integer CYCL_REG_P = 4'b0111;        // Register to hold cycles value
+    localparam integer SRAT_REG_P = 4'b1000;        // Register to hold sample rate value (Hz)
+    localparam integer CHAN_REG_P = 4'b1001;        // Register to read the channel count
+    localparam integer RUNM_REG_P = 4'b1010;        // Register to hold the run bit of every channel
+    localparam integer TRIG_REG_P = 4'b1011;        // Register to trigger a burst, write 1 per channel
+    localparam integer BDON_REG_P = 4'b1100;        // Register to read burst done bits, write 1 to clear
+    localparam integer TRGX_REG_P = 4'b1101;        // Register to hold the external trigger enables
+    localparam integer SRAT_RESET = 32'd50000;      // Sample rate after reset (Hz)
+
+    // Channel bank register numbers, bank n at 0x1000 + n * 0x20
+    localparam integer CTRL_BNK_P = 3'b000;         // Mode, hilbert and complement
+    localparam integer FREQ_BNK_P = 3'b001;         // Frequency (Hz)
+    localparam integer OFST_BNK_P = 3'b010;         // Offset
+    localparam integer AMPL_BNK_P = 3'b011;         // Amplitude
+    localparam integer DCYC_BNK_P = 3'b100;         // Duty cycle
+    localparam integer CYCL_BNK_P = 3'b101;         // Cycles
+    localparam integer PHAS_BNK_P = 3'b110;         // Phase offset
+
+    // Arbitrary sample tables, one 32-bit word per sample
+    // 0x2000-0x2FFF channel 0, 0x3000-0x3FFF channel 1, ...
+    reg [31:0] arbw_R_I_W;                          // Sample write: strobe, channel, index, sample
 
     // AXI4-lite signals
     reg axi_awready;
@@ -168,89 +209,162 @@ module wavegen_soc_v1_0_AXI #
         else                    axi_wready <= (wr_add_data_valid && ~axi_wready && aw_en);
     end
 
+    /* Register value at an address, as read back over the bus
+     * - global registers 0 to 7 gather channel 0 and 1 from their banks
+     * - sample tables and unused addresses read as 0
+     */
+    function [31:0] regWord(input [C_S_AXI_ADDR_WIDTH-1:0] addr);
+        reg [C_S_AXI_ADDR_WIDTH-13:0] block;
+        reg [6:0] ch;
+        begin
+            block   = addr[C_S_AXI_ADDR_WIDTH-1:12];
+            ch      = addr[11:05];
+            regWord = 32'b0;
+
+            if (block == GLOB_BLOCK)
+                case (addr[05:02])
+                    MODE_REG_P: regWord = {phas_R_I_WR[0], 8'b0, ctrl_R_I_WR[1][3], ctrl_R_I_WR[0][3],
+                                           ctrl_R_I_WR[1][2:0], ctrl_R_I_WR[0][2:0]};
+                    RUN__REG_P: regWord = {phas_R_I_WR[1], 12'b0, ctrl_R_I_WR[1][4], ctrl_R_I_WR[0][4], runn_R_I_WR[1:0]};
+                    FRQA_REG_P: regWord = freq_R_I_WR[0];
+                    FRQB_REG_P: regWord = freq_R_I_WR[1];
+                    OFST_REG_P: regWord = {ofst_R_I_WR[1], ofst_R_I_WR[0]};
+                    AMPL_REG_P: regWord = {ampl_R_I_WR[1], ampl_R_I_WR[0]};
+                    DCYC_REG_P: regWord = {dCyc_R_I_WR[1], dCyc_R_I_WR[0]};
+                    CYCL_REG_P: regWord = {cycl_R_I_WR[1], cycl_R_I_WR[0]};
+                    SRAT_REG_P: regWord = srat_R_I_WR;
+                    CHAN_REG_P: regWord = CHANNELS;
+                    RUNM_REG_P: regWord = runn_R_I_WR;
+                    BDON_REG_P: regWord = bdon_R_I_R;
+                    TRGX_REG_P: regWord = trgx_R_I_WR;
+                    default:    regWord = 32'b0;
+                endcase
+
+            else if (block == BANK_BLOCK && ch < CHANNELS)
+                case (addr[04:02])
+                    CTRL_BNK_P: regWord = ctrl_R_I_WR[ch];
+                    FREQ_BNK_P: regWord = freq_R_I_WR[ch];
+                    OFST_BNK_P: regWord = ofst_R_I_WR[ch];
+                    AMPL_BNK_P: regWord = ampl_R_I_WR[ch];
+                    DCYC_BNK_P: regWord = dCyc_R_I_WR[ch];
+                    CYCL_BNK_P: regWord = cycl_R_I_WR[ch];
+                    PHAS_BNK_P: regWord = phas_R_I_WR[ch];
+                    default:    regWord = 32'b0;
+                endcase
+        end
+    endfunction
+
     /* Write data to internal registers
      * - after address is valid (axi_awvalid)
      * - after write data is valid (axi_wvalid)
      * - after this module asserts ready for address handshake (axi_awready)
      * - after this module asserts ready for data handshake (axi_wready)
-     * write correct bytes in 32-bit word based on byte enables (axi_wstrb)
+     * write correct bytes in 32-bit word based on byte enables (axi_wstrb),
+     * the other bytes keep the value read back at the address
      */
      wire wr = wr_add_data_valid && axi_awready && axi_wready;
-    integer byte_index;
+    wire [31:00] wr_strb = {{8{axi_wstrb[3]}}, {8{axi_wstrb[2]}}, {8{axi_wstrb[1]}}, {8{axi_wstrb[0]}}};
+    wire [31:00] wr_word = (regWord(axi_awaddr) & ~wr_strb) | (S_AXI_WDATA & wr_strb);
+    wire [C_S_AXI_ADDR_WIDTH-13:0] wr_block = axi_awaddr[C_S_AXI_ADDR_WIDTH-1:12];
+    wire [04:00] wr_arb_ch = wr_block - ARB_BLOCK;
+    wire [06:00] wr_ch = axi_awaddr[11:05];
+    wire [CHANNELS-1:0] wr_ones = S_AXI_WDATA[CHANNELS-1:0] & wr_strb[CHANNELS-1:0];   // Bits written as 1, for TRIG and BDON
+    integer ch_index;
     always_ff @ (posedge axi_clk)
     begin
         if (axi_resetn == 1'b0)
         begin
-            mode_R_I_WR <= 32'd0;
-            runn_R_I_WR <= 32'd0;
-            frqA_R_I_WR <= 32'd0;
-            frqB_R_I_WR <= 32'd0;
-            ofst_R_I_WR <= 32'd0;
-            ampl_R_I_WR <= 32'd0;
-            dCyc_R_I_WR <= 32'd0;
-            cycl_R_I_WR <= 32'd0;
+            for (ch_index = 0; ch_index < CHANNELS; ch_index = ch_index+1)
+            begin
+                ctrl_R_I_WR[ch_index] <= 5'd0;
+                freq_R_I_WR[ch_index] <= 32'd0;
+                ofst_R_I_WR[ch_index] <= 16'd0;
+                ampl_R_I_WR[ch_index] <= 16'd0;
+                dCyc_R_I_WR[ch_index] <= 16'd0;
+                cycl_R_I_WR[ch_index] <= 16'd0;
+                phas_R_I_WR[ch_index] <= 16'd0;
+            end
+            runn_R_I_WR <= 0;
+            trig_R_I_W  <= 0;
+            trgx_R_I_WR <= 0;
+            srat_R_I_WR <= SRAT_RESET;
+            arbw_R_I_W  <= 32'd0;
         end
         else
         begin
-            if (wr)
+            arbw_R_I_W[31] <= 1'b0;                 // Strobe sample writes for one clock
+            if (wr && wr_block >= ARB_BLOCK)
             begin
-                case (axi_awaddr[4:2])
+                arbw_R_I_W <= {1'b1, wr_arb_ch, axi_awaddr[11:02], S_AXI_WDATA[15:00]};
+            end
+            else if (wr && wr_block == GLOB_BLOCK)
+            begin
+                case (axi_awaddr[5:2])
                     MODE_REG_P:
                     begin
-                        for (byte_index = 0; byte_index <= 3; byte_index = byte_index+1)
-                            if ( axi_wstrb[byte_index] == 1)
-                                mode_R_I_WR[(byte_index*8) +: 8] <= S_AXI_WDATA[(byte_index*8) +: 8];
+                        ctrl_R_I_WR[0][3:0] <= {wr_word[6], wr_word[2:0]};
+                        ctrl_R_I_WR[1][3:0] <= {wr_word[7], wr_word[5:3]};
+                        phas_R_I_WR[0]      <= wr_word[31:16];
                     end
 
                     RUN__REG_P:
                     begin
-                        for (byte_index = 0; byte_index <= 3; byte_index = byte_index+1)
-                            if (axi_wstrb[byte_index] == 1)
-                                runn_R_I_WR[(byte_index*8) +: 8] <= S_AXI_WDATA[(byte_index*8) +: 8];
-                    end
-
-                    FRQA_REG_P:
-                    begin
-                        for (byte_index = 0; byte_index <= 3; byte_index = byte_index+1)
-                            if (axi_wstrb[byte_index] == 1)
-                                frqA_R_I_WR[(byte_index*8) +: 8] <= S_AXI_WDATA[(byte_index*8) +: 8];
+                        runn_R_I_WR[1:0]    <= wr_word[1:0];
+                        ctrl_R_I_WR[0][4]   <= wr_word[2];
+                        ctrl_R_I_WR[1][4]   <= wr_word[3];
+                        phas_R_I_WR[1]      <= wr_word[31:16];
                     end
 
-                    FRQB_REG_P:
-                    begin
-                        for (byte_index = 0; byte_index <= 3; byte_index = byte_index+1)
-                            if (axi_wstrb[byte_index] == 1)
-                                frqB_R_I_WR[(byte_index*8) +: 8] <= S_AXI_WDATA[(byte_index*8) +: 8];
-                    end
+                    FRQA_REG_P: freq_R_I_WR[0] <= wr_word;
+                    FRQB_REG_P: freq_R_I_WR[1] <= wr_word;
 
-                    OFST_REG_P:
-                    begin
-                        for (byte_index = 0; byte_index <= 3; byte_index = byte_index+1)
-                            if (axi_wstrb[byte_index] == 1)
-                                ofst_R_I_WR[(byte_index*8) +: 8] <= S_AXI_WDATA[(byte_index*8) +: 8];
-                    end
-
-                    AMPL_REG_P:
-                    begin
-                        for (byte_index = 0; byte_index <= 3; byte_index = byte_index+1)
-                            if (axi_wstrb[byte_index] == 1)
-                                ampl_R_I_WR[(byte_index*8) +: 8] <= S_AXI_WDATA[(byte_index*8) +: 8];
-                    end
-                    DCYC_REG_P:
-                    begin
-                        for (byte_index = 0; byte_index <= 3; byte_index = byte_index+1)
-                            if (axi_wstrb[byte_index] == 1)
-                                dCyc_R_I_WR[(byte_index*8) +: 8] <= S_AXI_WDATA[(byte_index*8) +: 8];
-                    end
+                    OFST_REG_P: {ofst_R_I_WR[1], ofst_R_I_WR[0]} <= wr_word;
+                    AMPL_REG_P: {ampl_R_I_WR[1], ampl_R_I_WR[0]} <= wr_word;
+                    DCYC_REG_P: {dCyc_R_I_WR[1], dCyc_R_I_WR[0]} <= wr_word;
+                    CYCL_REG_P: {cycl_R_I_WR[1], cycl_R_I_WR[0]} <= wr_word;
 
-                    CYCL_REG_P:
-                    begin
-                        for (byte_index = 0; byte_index <= 3; byte_index = byte_index+1)
-                            if (axi_wstrb[byte_index] == 1)
-                                cycl_R_I_WR[(byte_index*8) +: 8] <= S_AXI_WDATA[(byte_index*8) +: 8];
-                    end
+                    SRAT_REG_P: srat_R_I_WR <= wr_word;
+                    RUNM_REG_P: runn_R_I_WR <= wr_word[CHANNELS-1:0];
+                    TRIG_REG_P: trig_R_I_W  <= trig_R_I_W ^ wr_ones;
+                    TRGX_REG_P: trgx_R_I_WR <= wr_word[CHANNELS-1:0];
                 endcase
             end
+            else if (wr && wr_block == BANK_BLOCK && wr_ch < CHANNELS)
+            begin
+                case (axi_awaddr[4:2])
+                    CTRL_BNK_P: ctrl_R_I_WR[wr_ch] <= wr_word[4:0];
+                    FREQ_BNK_P: freq_R_I_WR[wr_ch] <= wr_word;
+                    OFST_BNK_P: ofst_R_I_WR[wr_ch] <= wr_word[15:0];
+                    AMPL_BNK_P: ampl_R_I_WR[wr_ch] <= wr_word[15:0];
+                    DCYC_BNK_P: dCyc_R_I_WR[wr_ch] <= wr_word[15:0];
+                    CYCL_BNK_P: cycl_R_I_WR[wr_ch] <= wr_word[15:0];
+                    PHAS_BNK_P: phas_R_I_WR[wr_ch] <= wr_word[15:0];
+                endcase
+            end
+        end
+    end
+
+    /* Burst done bits
+     * - set when bdon_W_I toggles (generator clock domain, synchronized here)
+     * - cleared by writing 1 to the bit (BDON_REG_P)
+     */
+    reg [CHANNELS-1:0] bdon_S1, bdon_S2, bdon_S3;
+    wire bdon_clear = wr && wr_block == GLOB_BLOCK && axi_awaddr[5:2] == BDON_REG_P;
+    always_ff @ (posedge axi_clk)
+    begin
+        if (axi_resetn == 1'b0)
+        begin
+            bdon_S1    <= 0;
+            bdon_S2    <= 0;
+            bdon_S3    <= 0;
+            bdon_R_I_R <= 0;
+        end
+        else
+        begin
+            bdon_S1    <= bdon_W_I;
+            bdon_S2    <= bdon_S1;
+            bdon_S3    <= bdon_S2;
+            bdon_R_I_R <= (bdon_R_I_R & ~(bdon_clear ? wr_ones : {CHANNELS{1'b0}})) | (bdon_S2 ^ bdon_S3);
         end
     end
 
@@ -331,17 +445,8 @@ module wavegen_soc_v1_0_AXI #
         begin
             if (rd)
             begin
-                // Address decoding for reading registers
-                case (raddr[04:02])
-                    MODE_REG_P: axi_rdata <= mode_R_I_WR;
-                    RUN__REG_P: axi_rdata <= runn_R_I_WR;
-                    FRQA_REG_P: axi_rdata <= frqA_R_I_WR;
-                    FRQB_REG_P: axi_rdata <= frqB_R_I_WR;
-                    OFST_REG_P: axi_rdata <= ofst_R_I_WR;
-                    AMPL_REG_P: axi_rdata <= ampl_R_I_WR;
-                    DCYC_REG_P: axi_rdata <= dCyc_R_I_WR;
-                    CYCL_REG_P: axi_rdata <= cycl_R_I_WR;
-                endcase
+                // Address decoding for reading registers (sample tables are write only)
+                axi_rdata <= regWord(raddr);
             end
         end
     end
@@ -374,12 +479,27 @@ module wavegen_soc_v1_0_AXI #
     end
 
     // Assign outputs
-    assign mode_W_O = mode_R_I_WR;
+    genvar ch;
+    generate
+        for (ch = 0; ch < CHANNELS; ch = ch+1)
+        begin : channel_outputs
+            assign mode_W_O[ch*3 +: 3]   = ctrl_R_I_WR[ch][2:0];
+            assign hilb_W_O[ch]          = ctrl_R_I_WR[ch][3];
+            assign comp_W_O[ch]          = ctrl_R_I_WR[ch][4];
+            assign freq_W_O[ch*32 +: 32] = freq_R_I_WR[ch];
+            assign ofst_W_O[ch*16 +: 16] = ofst_R_I_WR[ch];
+            assign ampl_W_O[ch*16 +: 16] = ampl_R_I_WR[ch];
+            assign dCyc_W_O[ch*16 +: 16] = dCyc_R_I_WR[ch];
+            assign cycl_W_O[ch*16 +: 16] = cycl_R_I_WR[ch];
+            assign phas_W_O[ch*16 +: 16] = phas_R_I_WR[ch];
+        end
+    endgenerate
+
     assign runn_W_O = runn_R_I_WR;
-    assign frqA_W_O = frqA_R_I_WR;
-    assign frqB_W_O = frqB_R_I_WR;
-    assign ofst_W_O = ofst_R_I_WR;
-    assign ampl_W_O = ampl_R_I_WR;
-    assign dCyc_W_O = dCyc_R_I_WR;
-    assign cycl_W_O = cycl_R_I_WR;
+    assign srat_W_O = srat_R_I_WR;
+    assign arbw_W_O = arbw_R_I_W;
+    assign arbc_W_O = axi_clk;
+    assign trig_W_O = trig_R_I_W;
+    assign trgx_W_O = trgx_R_I_WR;
+    assign irq      = |bdon_R_I_R;
 endmodule
\ No newline at end of file
@@ -1,6 +1,10 @@
 `timescale 1ns / 1ps
 
-module wavegen_system_top(
+module wavegen_system_top #
+    (
+        parameter integer CHANNELS = 2      // Must match CHANNELS of the wavegen_soc IP, two per DAC
+    )
+    (
         input CLK100,
     output [9:0] LED,       // RGB1, RGB0, LED 9..0 placed from left to right
     output [2:0] RGB0,
@@ -48,9 +52,9 @@ module wavegen_system_top(
     inout FIXED_IO_ps_porb,
     inout FIXED_IO_ps_srstb,
 
-    output CS_,
-    output CLK_SPI,
-    output SDI,
+    output [CHANNELS/2-1:0] CS_,    // One chip select and data line per DAC,
+    output CLK_SPI,                 // SCLK and LDAC_ shared by every DAC
+    output [CHANNELS/2-1:0] SDI,
     output LDAC_
     );
 
@@ -75,96 +79,69 @@ module wavegen_system_top(
     assign SS_ANODE = 4'b0111;
     assign SS_CATHODE = 8'b10010000;
 
-//REGISTERS FROM AXI BUS EXPOSED TO TOP MODULE
-    wire [31:00] ampl_W_I;
-    wire [31:00] cycl_W_I;
-    wire [31:00] dCyc_W_I;
-    wire [31:00] frqA_W_I;
-    wire [31:00] frqB_W_I;
-    wire [31:00] mode_W_I;
-    wire [31:00] ofst_W_I;
-    wire [31:00] runn_W_I;
+//REGISTERS FROM AXI BUS EXPOSED TO TOP MODULE (channel n in bits [n*width +: width])
+    wire [CHANNELS*16-1:0] ampl_W_I;
+    wire [CHANNELS*16-1:0] cycl_W_I;
+    wire [CHANNELS*16-1:0] dCyc_W_I;
+    wire [CHANNELS*32-1:0] freq_W_I;
+    wire [CHANNELS*3-1:0]  mode_W_I;
+    wire [CHANNELS*16-1:0] ofst_W_I;
+    wire [CHANNELS*16-1:0] phas_W_I;
+    wire [CHANNELS-1:0]    runn_W_I;
+    wire [CHANNELS-1:0]    hilb_W_I;
+    wire [CHANNELS-1:0]    comp_W_I;
+    wire [31:00] srat_W_I;                      // Sample rate (Hz)
+    wire [31:00] arbw_W_I;                      // Arbitrary sample writes
+    wire arbc_W_I;                              // Arbitrary sample write clock (AXI clock)
+    wire [CHANNELS-1:0]    trig_W_I;            // Software burst triggers (toggles)
+    wire [CHANNELS-1:0]    trgx_W_I;            // Channels started by the external trigger
+    wire [CHANNELS-1:0]    burst_done;          // Finished bursts (toggles), burst done interrupt in the IP
+
+//EXTERNAL BURST TRIGGER, rising edge on PMODA 1P (GPIO is never driven)
+    wire trig_ext = GPIO[0];
+
+//SAMPLE STREAM FROM AXI DMA (MM2S)
+    wire [31:00] strm_tdata;
+    wire strm_tvalid;
+    wire strm_tready;
+    wire strm_aclk;
+    wire strm_underflow;
 
     wire clk = CLK100;
 
     vio_0 axitest (
         .clk(clk),              // input wire clk
-        .probe_in0(ampl_W_I),  // input wire [31 : 0] probe_in0
-        .probe_in1(cycl_W_I),  // input wire [31 : 0] probe_in1
-        .probe_in2(dCyc_W_I),  // input wire [31 : 0] probe_in2
-        .probe_in3(frqA_W_I),  // input wire [31 : 0] probe_in3
-        .probe_in4(frqB_W_I),  // input wire [31 : 0] probe_in4
-        .probe_in5(mode_W_I),  // input wire [31 : 0] probe_in5
-        .probe_in6(ofst_W_I),  // input wire [31 : 0] probe_in6
-        .probe_in7(runn_W_I),  // input wire [31 : 0] probe_in7
-        .probe_in8(dacA_Val),
-        .probe_in9(dacB_Val)
+        .probe_in0(ampl_W_I[31:0]),  // input wire [31 : 0] probe_in0 (channel 0 and 1)
+        .probe_in1(cycl_W_I[31:0]),  // input wire [31 : 0] probe_in1
+        .probe_in2(dCyc_W_I[31:0]),  // input wire [31 : 0] probe_in2
+        .probe_in3(freq_W_I[31:0]),  // input wire [31 : 0] probe_in3
+        .probe_in4(freq_W_I[63:32]), // input wire [31 : 0] probe_in4
+        .probe_in5(mode_W_I[5:0]),   // input wire [31 : 0] probe_in5
+        .probe_in6(ofst_W_I[31:0]),  // input wire [31 : 0] probe_in6
+        .probe_in7(runn_W_I),        // input wire [31 : 0] probe_in7
+        .probe_in8(dac_Val[11:0]),
+        .probe_in9(dac_Val[23:12])
     );
 
 //AXI bus register space
-    reg [5:0] mode_regVal;
-    reg [2:0] modeA;
-    reg [2:0] modeB;
-
-
-    reg signed [31:0] offset_regVal;
-    reg signed [15:0] offset_dc_A;
-    reg signed [15:0] offset_dc_B;
-
-    reg signed [31:0] ampl_regVal;
-    reg signed [15:0] amplA_R;
-    reg signed [15:0] amplB_R;
-
-    reg signed [31:0] dutyCyc_regVal;
-    reg signed [15:0] dutyCycA;
-    reg signed [15:0] dutyCycB;
-
-    reg signed [31:0] cycles_regVal;
-    reg signed [15:0] cyclesA;
-    reg signed [15:0] cyclesB;
-
-    reg [31:0] freqA_count;
-    reg [31:0] freqB_count;
-
-    assign mode_regVal      = mode_W_I;
-    assign run_regVal       = runn_W_I;
-    assign freqA_regVal     = frqA_W_I;
-    assign freqB_regVal     = frqB_W_I;
-    assign offset_regVal    = ofst_W_I;
-    assign ampl_regVal      = ampl_W_I;
-    assign dutyCyc_regVal   = dCyc_W_I;
-    assign cycles_regVal    = cycl_W_I;
-
-    assign modeA            = mode_regVal [02:00];
-    assign modeB            = mode_regVal [05:03];
-    assign runA             = run_regVal;
-    assign runB             = run_regVal;
-    assign offset_dc_A      = offset_regVal [15:00];
-    assign offset_dc_B      = offset_regVal [31:16];
-    assign amplA            = ampl_regVal [15:0];
-    assign amplB            = ampl_regVal [31:16];
-    assign dutyCycA         = dutyCyc_regVal [15:0];
-    assign dutyCycB         = dutyCyc_regVal [31:16];
-    assign cyclesA          = cycles_regVal [15:00];
-    assign cyclesB          = cycles_regVal [31:16];
-
-    assign freqA_count = 100000000 / freqA_regVal; // 100Mhz/desired frequency
-    assign freqB_count = 100000000 / freqB_regVal;
+    reg [31:0] srate_regVal;                    // Samples per second
 
+    assign srate_regVal     = (srat_W_I == 0) ? 32'd50000 : srat_W_I;      // 0 = power up rate
 
 // SPI WIRES TO DAC BLOCK
-    wire cs_connect;
-    wire sdi_connect;
-    wire ldac_connect;
+    localparam integer DACS = CHANNELS / 2;     // Dual DAC per channel pair
+    wire [DACS-1:0] cs_connect;
+    wire [DACS-1:0] sdi_connect;
+    wire [DACS-1:0] ldac_connect;
+    wire [DACS-1:0] sclk_connect;
+    wire [DACS-1:0] spi_busy;
 
 //WAVE VARIABLES
 //SINE VARIABLES
     wire [15:00] Asin_w;
 
     wire CLK50K;
-    reg clk_spibus;
-    reg [15:00] CLK50K_load = 16'd1000;
-    reg[15:0] spi_clk_count = 16'd25;   // 2Mhz clock
+    reg [15:00] CLK50K_load;
 
     reg [11:00] addrA = 12'h0, addrB = 12'h800;
     reg [15:00] cosFromCoe, sinFromCoe;
@@ -172,21 +149,20 @@ module wavegen_system_top(
 //SAWTOOTH,TRIANGLE,SQUARE VARIABLES
     reg signed [15:00] sawTW_A, sawTW_B;        // Outputs from the sawtooth module
     reg signed [15:00] trgW_A, trgW_B;          // Outputs from the triangle module
-    reg [11:00] dacA_Val, dacB_Val;
+    reg [CHANNELS*12-1:0] dac_Val;              // DAC word of channel n in bits [n*12 +: 12]
 
 //DC OFFSET VARIABLES
     reg [31:00] ofst_R_E;
 
-//50KHZ SAMPLING CLOCK AND SPI WRITE TO DAC
+//SAMPLING CLOCK (srate_regVal, 50KHz after reset) AND SPI WRITE TO DAC
     getClock CLK50K_I (.clk(clk), .count_to_freq(CLK50K_load),.out_clk1(CLK50K));
 
-    getClock spi(.clk(clk), .count_to_freq(spi_clk_count),.out_clk1(clk_spibus)); // Get a 2Mhz  Spi Clk
-
-    // Connect the wires coming from the spiModule to the Top Module ports
+    // Connect the wires coming from the spiModules to the Top Module ports
+    // (every engine loads on the same clk, so SCLK and LDAC_ of DAC 0 serve all)
     assign CS_      = cs_connect;
-    assign CLK_SPI  = clk_spibus;
+    assign CLK_SPI  = sclk_connect[0];
     assign SDI      = sdi_connect;
-    assign LDAC_    = ldac_connect;
+    assign LDAC_    = ldac_connect[0];
 //SPI WRITE ENDS
 
 //PROBES
@@ -194,14 +170,6 @@ module wavegen_system_top(
     reg enableA_probe;
     reg enableB_probe;
 
-//CLOCKS
-    reg clk_variableA;
-    reg clk_variableB;
-
-
-    getClock clks_for_wavesA (.clk(clk), .count_to_freq(freqA_count), .out_clk1(clk_variableA));
-    getClock clks_for_wavesB (.clk(clk), .count_to_freq(freqB_count), .out_clk1(clk_variableB));
-
 //SYNCHRONIZATION WITH 50Khz sampling frequency
     reg clk_50KHz_del;
     wire pulse_50KHz;
@@ -212,161 +180,67 @@ module wavegen_system_top(
 
     assign pulse_50KHz   =  CLK50K & ~clk_50KHz_del;
 
-//SYNC END
-    //MODE SELECTION FOR CHANNEL A AND B AND CHANNEL ENABLES
-    reg dcOffsetEnable_A, sineEnable_A, sawtoothEnable_A, triangleEnable_A, squareEnable_A, arbitaryEnable_A;
-    reg dcOffsetEnable_B, sineEnable_B, sawtoothEnable_B, triangleEnable_B, squareEnable_B, arbitaryEnable_B;
-
-    // Square Wave Registers
-    reg [11:0] dacA_sq;   // Declare register for dacA_sq
-    reg [11:0] dacB_sq;   // Declare register for dacB_sq
-
-    // Sawtooth Wave Registers
-    reg [11:0] dacA_saw;  // Declare register for dacA_saw
-    reg [11:0] dacB_saw;  // Declare register for dacB_saw
-
-    // Triangle Wave Registers
-    reg [11:0] dacA_tri;  // Declare register for dacA_tri
-    reg [11:0] dacB_tri;  // Declare register for dacB_tri
-
-    // Sine Wave Registers
-    reg [11:0] dacA_sine; // Declare register for dacA_sine
-    reg [11:0] dacB_sine; // Declare register for dacB_sine
-
-    // DC Offset Registers
-    reg [11:0] dacA_dc;   // Declare register for dacA_dc
-    reg [11:0] dacB_dc;   // Declare register for dacB_dc
-
-    reg [63:0] deltaPhaseA;
-    reg [63:0] deltaPhaseB;
-
-    reg [15:0] stepcountA;
-    reg [15:0] stepcountB;
+    // dac_Val is registered on pulse_50KHz, hand them to the SPI engine one clk later
+    reg spi_load;
+    always_ff@(posedge clk)
+    begin
+       spi_load <= pulse_50KHz;
+    end
 
-    reg [15:0] stepValA;
-    reg [15:0] stepValB;
+//SYNC END
+    //MODE SELECTION FOR EVERY CHANNEL
+    // Words computed by the shared sample pipeline (modes 0-5)
+    reg [CHANNELS*12-1:0] dac_pipe;
+    wire pipe_busy;
 
-    // reg [15:0] freqA_count;
-    // reg [15:0] freqB_count;
+    // Stream Registers (channel 0 and 1 only)
+    reg [11:0] dacA_strm; // Declare register for dacA_strm
+    reg [11:0] dacB_strm; // Declare register for dacB_strm
 
-    reg [31:0] mul_resultA;
-    reg [31:0] mul_resultB;
+    reg [CHANNELS*32-1:0] deltaPhase;
 
+    // Step values computed once per register write (no dividers on the sampling pulse)
+    reg [CHANNELS*32-1:0] deltaPhase_calc;
+    wire step_busy;
 
-    reg [31:0] freqA_regVal;
-    reg [31:0] freqB_regVal;
+    stepCalc #(
+        .CHANNELS(CHANNELS)
+    ) steps (
+        .clk(clk),
+        .srate(srate_regVal),
+        .freq(freq_W_I),
+        .sampleLoad(CLK50K_load),               // 50000000 / sample rate
+        .deltaPhase(deltaPhase_calc),           // 32 bit accumulator step values
+        .busy(step_busy)
+    );
 
-    reg signed [15:0] amplA;
-    reg signed [15:0] amplB;
+    // Calibration of each DAC output, nominal for channels past the first DAC
+    wire [CHANNELS*16-1:0] cal_slope;
+    wire [CHANNELS*12-1:0] cal_intercept;
 
-    reg [2:0] modeA_R;
-    reg [2:0] modeB_R;
+    // Select the DAC word of each channel
+    genvar ch;
+    generate
+        for (ch = 0; ch < CHANNELS; ch = ch + 1)
+        begin : channel_select
+            assign cal_slope[ch*16 +: 16]     = (ch == 0) ? 16'd1961 : (ch == 1) ? 16'd1947 : 16'd2048;    // Caliberation slope values
+            assign cal_intercept[ch*12 +: 12] = (ch == 0) ? 12'd24   : (ch == 1) ? 12'd33   : 12'd0;       // Caliberation intercept values
 
+            wire stream_mode = (ch < 2) && (mode_W_I[ch*3 +: 3] == 3'd6);
+            wire [11:0] strm_word = (ch == 0) ? dacA_strm : dacB_strm;
 
-    // Enable the respective modules for Channel A
-    always_ff @(posedge clk)
-    begin
-        if (pulse_50KHz)
-        begin
-            // Default: Disable all modules for Channel A
-            dcOffsetEnable_A    <= 1'b0;
-            sineEnable_A        <= 1'b0;
-            sawtoothEnable_A    <= 1'b0;
-            triangleEnable_A    <= 1'b0;
-            squareEnable_A      <= 1'b0;
-            arbitaryEnable_A    <= 1'b0;
-
-            case (modeA)
-                6'd0:
-                begin
-                    dcOffsetEnable_A    <= 1'b1;                                        // Enable DC Offset for Channel A
-                    dacA_Val            <= dacA_dc;
-                end
-                6'd1:
-                begin
-                    sineEnable_A        <= 1'b1;                                        // Enable Sine for Channel A
-                    deltaPhaseA         <= ((freqA_regVal * 32'hFFFFFFFF) / 50000);     // 32 bit accumulator step value
-                    dacA_Val            <= dacA_sine;
-                end
-                6'd2:
-                begin
-                    sawtoothEnable_A    <= 1'b1;                                        // Enable Sawtooth for Channel A
-                    stepcountA          <= 50000 / freqA_regVal;
-                    stepValA            <= ((2 * amplA )/ stepcountA);
-                    dacA_Val            <= dacA_saw;
-                end
-                6'd3:
-                begin
-                    triangleEnable_A    <= 1'b1;                                        // Enable Triangle for Channel A
-                    stepcountA          <= 25000 / freqA_regVal;
-                    stepValA            <= ((2 * amplA) / stepcountA);
-                    dacA_Val            <= dacA_tri;
-                end
-                6'd4:
-                begin
-                    squareEnable_A      <= 1'b1;                                        // Enable Square for Channel A
-                    dacA_Val            <= dacA_sq;
-                end
-                6'd5:
+            always_ff @(posedge clk)
+            begin
+                if (pulse_50KHz)
                 begin
-                    arbitaryEnable_A    <= 1'b1;                                        // Enable Arbitrary for Channel A
-                    // dacA_Val <= dacA_arb;
-                end
-            endcase
-        end
-    end
-    // Enable the respective modules for Channel B
-    always_ff @(posedge clk)
-    begin
-        if (pulse_50KHz)
-        begin
-            // Default: Disable all modules for Channel B
-            dcOffsetEnable_B    <= 1'b0;
-            sineEnable_B        <= 1'b0;
-            sawtoothEnable_B    <= 1'b0;
-            triangleEnable_B    <= 1'b0;
-            squareEnable_B      <= 1'b0;
-            arbitaryEnable_B    <= 1'b0;
-                // For modeB
-            case (modeB)
-                6'd0:
-                begin
-                    dcOffsetEnable_B    <= 1'b1;                                        // Enable DC Offset for Channel B
-                    dacB_Val            <= dacB_dc;
-                end
-                6'd1:
-                begin
-                    sineEnable_B        <= 1'b1;                                        // Enable Sine for Channel B
-                    deltaPhaseB         <= ((freqB_regVal * 32'hFFFFFFFF) / 50000);     // 32 bit accumulator step value
-                    dacB_Val            <= dacB_sine;
-                end
-                6'd2:
-                begin
-                    sawtoothEnable_B    <= 1'b1;                                        // Enable Sawtooth for Channel B
-                    stepcountB          <= 50000 / freqB_regVal;
-                    stepValB            <= ((2 * amplB) / stepcountB);
-                    dacB_Val            <= dacB_saw;
-                end
-                6'd3:
-                begin
-                    triangleEnable_B    <= 1'b1;                                        // Enable Triangle for Channel B
-                    stepcountB          <= 25000 / freqB_regVal;
-                    stepValB            <= ((2 * amplB) / stepcountB);
-                    dacB_Val            <= dacB_tri;
-                end
-                6'd4:
-                begin
-                    squareEnable_B      <= 1'b1;                                        // Enable Square for Channel B
-                    dacB_Val            <= dacB_sq;
-                end
-                6'd5:
-                begin
-                    arbitaryEnable_B    <= 1'b1;                                        // Enable Arbitrary for Channel B
-                    // dacB_Val <= dacB_arb;
+                    deltaPhase[ch*32 +: 32] <= deltaPhase_calc[ch*32 +: 32];                   // 32 bit accumulator step value, every mode
+
+                    if (stream_mode)    dac_Val[ch*12 +: 12] <= strm_word;                      // Samples streamed from DDR by the AXI DMA
+                    else                dac_Val[ch*12 +: 12] <= dac_pipe[ch*12 +: 12];          // dc, sine, saw, tri, sq, arb
                 end
-            endcase
+            end
         end
-    end
+    endgenerate
 
     // Instantiate system wrapper
     system_wrapper system (
@@ -393,107 +267,82 @@ module wavegen_system_top(
         .FIXED_IO_ps_srstb(FIXED_IO_ps_srstb),
         .ampl_W_O(ampl_W_I),                        // Get register values from lower levels
         .cycl_W_O(cycl_W_I),                        // Get register values from lower levels
+        .srat_W_O(srat_W_I),                        // Get register values from lower levels
         .dCyc_W_O(dCyc_W_I),                        // Get register values from lower levels
-        .frqA_W_O(frqA_W_I),                        // Get register values from lower levels
-        .frqB_W_O(frqB_W_I),                        // Get register values from lower levels
+        .freq_W_O(freq_W_I),                        // Get register values from lower levels
         .mode_W_O(mode_W_I),                        // Get register values from lower levels
         .ofst_W_O(ofst_W_I),                        // Get register values from lower levels
-        .runn_W_O(runn_W_I)                         // Get register values from lower levels
+        .phas_W_O(phas_W_I),                        // Get register values from lower levels
+        .runn_W_O(runn_W_I),                        // Get register values from lower levels
+        .hilb_W_O(hilb_W_I),                        // Get register values from lower levels
+        .comp_W_O(comp_W_I),                        // Get register values from lower levels
+        .trig_W_O(trig_W_I),                        // Get burst triggers from lower levels
+        .trgx_W_O(trgx_W_I),                        // Get register values from lower levels
+        .bdon_W_I(burst_done),                      // Finished bursts to the burst done interrupt
+        .arbw_W_O(arbw_W_I),                        // Get sample writes from lower levels
+        .arbc_W_O(arbc_W_I),                        // Get sample write clock from lower levels
+        .SAMP_AXIS_tdata(strm_tdata),               // AXI DMA MM2S stream
+        .SAMP_AXIS_tvalid(strm_tvalid),
+        .SAMP_AXIS_tready(strm_tready),
+        .SAMP_AXIS_aclk(strm_aclk)
     );
 
-    // Instantiate dcOut module
-    dcOut dc_inst(
+    // One datapath for every mode of every channel, channels issued one per clock
+    samplePipeline #(
+        .CHANNELS(CHANNELS)
+    ) pipe_inst (
         .clk(clk),
         .clk_sampling(pulse_50KHz),
-        .enableA(dcOffsetEnable_A),
-        .enableB(dcOffsetEnable_B),
-        .dc_ofsA(offset_dc_A),
-        .dc_ofsB(offset_dc_B),
-        .dacA_dc_fin(dacA_dc),
-        .dacB_dc_fin(dacB_dc)
+        .mode(mode_W_I),
+        .delta_phase(deltaPhase),
+        .ampl(ampl_W_I),
+        .dc_ofs(ofst_W_I),
+        .duty(dCyc_W_I),
+        .phase_ofs(phas_W_I),
+        .phase_sync(runn_W_I),
+        .hilbert(hilb_W_I),
+        .cycles(cycl_W_I),
+        .trig_sw(trig_W_I),
+        .trig_ext_en(trgx_W_I),
+        .trig_ext(trig_ext),
+        .cal_slope(cal_slope),
+        .cal_intercept(cal_intercept),
+        .wr_clk(arbc_W_I),
+        .wr_sample(arbw_W_I),
+        .dac_words(dac_pipe),
+        .burst_done(burst_done),
+        .busy(pipe_busy)
     );
 
-    // Instantiate squareWave module for Channel A
-    squareWave square_inst(
+    streamIn stream_inst (
         .clk(clk),
         .clk_sampling(pulse_50KHz),
-        .clkA(clk_variableA),
-        .clkB(clk_variableB),
-
-        .enableA(squareEnable_A),
-        .enableB(squareEnable_B),
-
-        .dc_ofsA(offset_dc_A),
-        .dc_ofsB(offset_dc_B),
-        .ampl_A(amplA),
-        .ampl_B(amplB),
-        .dutyA(16'd1),
-        .dutyB(16'd1),
-
-        .dacA_sq_signed(dacA_sq),
-        .dacB_sq_signed(dacB_sq)
-    );
-
-    sawToothWave saw_inst (
-        .clk(clk),                          // Provide the main clock
-        .clk_sampling(pulse_50KHz),         // Provide the sampling clock
-        .enableA(sawtoothEnable_A),
-        .enableB(sawtoothEnable_B),
-        .ampl_A(amplA),
-        .ampl_B(ampl_B),
-        .dc_ofsA(offset_dc_A),
-        .dc_ofsB(offset_dc_B),
-        .maxStepCountA(stepcountA),         // Number of writes for desired frequency A
-        .maxStepCountB(stepcountB),         // Number of writes for desired frequency B
-        .stepValA(stepValA),                // Step value for A
-        .stepValB(stepValB),                // Step value for B
-
-        .dacA_saw_fin(dacA_saw),            // Output for DAC A
-        .dacB_saw_fin(dacB_saw)             // Output for DAC B
-    );
-
-    triangleWave triangle_inst (
-        .clk(clk),
-        .clk_sampling(pulse_50KHz),
-        .enableA(triangleEnable_A),
-        .enableB(triangleEnable_B),
-        .ampl_A(amplA),
-        .ampl_B(ampl_B),
-        .dc_ofsA(offset_dc_A),
-        .dc_ofsB(offset_dc_B),
-        .halfMaxStepCountA(stepcountA),
-        .halfMaxStepCountB(stepcountB),
-        .stepValA(stepValA),
-        .stepValB(stepValB_probe),
-        .dacA_tri_fin(dacA_tri),
-        .dacB_tri_fin(dacB_tri)
+        .enable((mode_W_I[2:0] == 3'd6) || (mode_W_I[5:3] == 3'd6)),
+        .s_axis_aclk(strm_aclk),
+        .s_axis_tdata(strm_tdata),
+        .s_axis_tvalid(strm_tvalid),
+        .s_axis_tready(strm_tready),
+        .underflow(strm_underflow),
+        .dacA_strm_fin(dacA_strm),
+        .dacB_strm_fin(dacB_strm)
     );
 
-
-    sineWave sine_inst (
-        .clk(clk),
-        .clk_sampling(pulse_50KHz),
-        .enableA(sineEnable_A),
-        .enableB(sineEnable_B),
-        .dc_ofsA(offset_dc_A),
-        .dc_ofsB(offset_dc_B),
-        .ampl_A(amplA),
-        .ampl_B(amplB),
-        .phaseA_offset(16'd0),
-        .phaseB_offset(16'd0),
-        .delta_phaseA(deltaPhaseA),
-        .delta_phaseB(deltaPhaseB),
-        .dacA_sine_fin(dacA_sine),
-        .dacB_sine_fin(dacB_sine)
-    );
-
-    spiModule spiwrite (
-        .clk(clk),
-        .clk_spi(clk_spibus),
-        .dacA_in(dacA_Val),         // dacA_Val and dacB_Val will be final values output from the modules
-        .dacB_in(dacB_Val),
-        .chipselect(cs_connect),
-        .sdi(sdi_connect),
-        .ldac(ldac_connect)
-    );
+    // One SPI engine per dual DAC, channel 2k on DAC A and 2k+1 on DAC B of DAC k
+    genvar dac;
+    generate
+        for (dac = 0; dac < DACS; dac = dac + 1)
+        begin : dac_spi
+            spiModule spiwrite (
+                .clk(clk),
+                .load(spi_load),
+                .dacA_in(dac_Val[(2*dac)*12 +: 12]),        // dac_Val will be final values output from the modules
+                .dacB_in(dac_Val[(2*dac+1)*12 +: 12]),
+                .chipselect(cs_connect[dac]),
+                .sclk(sclk_connect[dac]),
+                .sdi(sdi_connect[dac]),
+                .ldac(ldac_connect[dac]),
+                .busy(spi_busy[dac])
+            );
+        end
+    endgenerate
 endmodule